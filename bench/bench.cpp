@@ -0,0 +1,553 @@
+// Benchmark suite of the whole pipeline of the application: derivation of the
+// L-systems, turtle interpretation, painting, bounding boxes, and
+// serialization.
+//
+// The corpus is made of the files of 'saves/' and of classic curves at
+// increasing iteration counts. For each benchmark, the harness reports the
+// mean time per run, the throughput (symbols/s, vertices/s, or files/s) and the
+// peak of heap memory allocated during the benchmark (tracked by the Profiler).
+//
+// Usage (from the root of the repository, see 'make bench'):
+//   bench/procgenBench.out [filter]
+// Only the benchmarks whose name contains 'filter' are run.
+
+#include <chrono>
+#include <cstdio>
+#include <experimental/filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+#include "cereal/archives/json.hpp"
+
+#include "LSystem.h"
+#include "DrawingParameters.h"
+#include "InterpretationMap.h"
+#include "LSystemView.h"
+#include "Observer.h"
+#include "Turtle.h"
+#include "geometry.h"
+#include "helper_math.h"
+#include "Production.h"
+#include "Profiler.h"
+#include "SceneRegistry.h"
+#include "UniqueId.h"
+#include "VertexPainterComposite.h"
+#include "VertexPainterConstant.h"
+#include "VertexPainterIteration.h"
+#include "VertexPainterLinear.h"
+#include "VertexPainterRadial.h"
+#include "VertexPainterRandom.h"
+#include "VertexPainterSequential.h"
+
+namespace fs = std::experimental::filesystem;
+using namespace drawing;
+using namespace math;
+
+namespace
+{
+    // --- Harness ---
+
+    // Minimum cumulated time and maximum number of runs of a benchmark.
+    constexpr double min_time = 0.2;
+    constexpr unsigned long max_runs = 1000;
+
+    std::string filter;
+
+    // Written by the benchmarks whose result would otherwise be optimized
+    // away.
+    volatile unsigned long sink = 0;
+
+    // Run 'f' until 'min_time' is reached and print the mean time of a run,
+    // the throughput of 'items' 'unit' per run, and the peak of heap memory.
+    template<typename F>
+    void run(const std::string& name, double items, const char* unit, F&& f)
+    {
+        if (name.find(filter) == std::string::npos)
+        {
+            return;
+        }
+
+        std::size_t base_bytes = Profiler::live_bytes();
+        Profiler::reset_peak_bytes();
+
+        using clock = std::chrono::steady_clock;
+        std::chrono::duration<double> total {0};
+        unsigned long runs = 0;
+        do
+        {
+            auto start = clock::now();
+            f();
+            total += clock::now() - start;
+            ++runs;
+        } while (total.count() < min_time && runs < max_runs);
+
+        double mean = total.count() / runs;
+        std::printf("%-48s %8lu runs %12.3f ms %14.0f %s/s %10.2f MiB\n",
+                    name.c_str(), runs, mean * 1e3, items / mean, unit,
+                    (Profiler::peak_bytes() - base_bytes) / (1024. * 1024.));
+    }
+
+    // --- Corpus ---
+
+    struct Entry
+    {
+        std::string name;
+        LSystem lsys;
+        DrawingParameters params;
+        InterpretationMap map;
+    };
+
+    // Same format as a LSystemView saved in 'saves/', without the View.
+    struct SavedView
+    {
+        std::string name;
+        LSystem lsys;
+        DrawingParameters params;
+        InterpretationMap map;
+
+        template<class Archive>
+        void save (Archive& ar, const std::uint32_t) const
+            {
+                ar(cereal::make_nvp("name", name),
+                   cereal::make_nvp("LSystem", lsys),
+                   cereal::make_nvp("DrawingParameters", params),
+                   cereal::make_nvp("Interpretation Map", map));
+            }
+
+        template<class Archive>
+        void load (Archive& ar, const std::uint32_t)
+            {
+                ar(name,
+                   cereal::make_nvp("LSystem", lsys),
+                   cereal::make_nvp("DrawingParameters", params),
+                   cereal::make_nvp("Interpretation Map", map));
+            }
+    };
+
+    std::vector<Entry> load_saves(const fs::path& directory)
+    {
+        std::vector<Entry> entries;
+        if (!fs::exists(directory))
+        {
+            return entries;
+        }
+        for (const auto& file : fs::directory_iterator(directory))
+        {
+            std::ifstream ifs (file.path());
+            SavedView view;
+            {
+                cereal::JSONInputArchive archive (ifs);
+                archive(view);
+            }
+            entries.push_back({"saves/" + file.path().filename().string(),
+                               view.lsys, view.params, view.map});
+        }
+        return entries;
+    }
+
+    // Classic curves at increasing iteration counts.
+    std::vector<Entry> classic_curves()
+    {
+        InterpretationMap map { { 'F', go_forward },
+                                { 'G', go_forward },
+                                { 'A', go_forward },
+                                { 'B', go_forward },
+                                { '-', turn_left  },
+                                { '+', turn_right },
+                                { '[', save_position },
+                                { ']', load_position } };
+        struct Curve
+        {
+            std::string name;
+            LSystem lsys;
+            double delta_angle;
+            std::vector<int> iterations;
+        };
+        std::vector<Curve> curves
+        {
+            {"koch", {"F", {{'F', "F+F-F-F+F"}}, ""}, 90, {3, 5, 7}},
+            {"sierpinski", {"A", {{'A', "B-A-B"}, {'B', "A+B+A"}}, ""}, 60, {6, 9, 12}},
+            {"dragon", {"FX", {{'X', "X+YF+"}, {'Y', "-FX-Y"}}, ""}, 90, {10, 14, 18}},
+            {"hilbert", {"A", {{'A', "+BF-AFA-FB+"}, {'B', "-AF+BFB+FA-"}}, ""}, 90, {4, 6, 8}},
+            {"plant", {"X", {{'X', "F[-X][X]F[-X]+FX"}, {'F', "FF"}}, "X"}, 25, {4, 6, 8}},
+        };
+
+        std::vector<Entry> entries;
+        for (const auto& curve : curves)
+        {
+            for (int n : curve.iterations)
+            {
+                DrawingParameters params { {0, 0}, 0, degree_to_rad(curve.delta_angle), 5, n };
+                entries.push_back({curve.name + "/n=" + std::to_string(n), curve.lsys, params, map});
+            }
+        }
+        return entries;
+    }
+
+    // --- Benchmarks ---
+
+    void bench_entry(const Entry& entry)
+    {
+        int n = entry.params.get_n_iter();
+
+        // The LSystem of the entry is never derived: each run starts from an
+        // empty cache.
+        LSystem derived = entry.lsys;
+        double n_symbols = std::get<0>(derived.produce(n)).size();
+        run("produce/" + entry.name, n_symbols, "symbols",
+            [&entry, n]()
+            {
+                LSystem lsys = entry.lsys;
+                lsys.produce(n);
+            });
+
+        // The same derivation, compressed: the length tables, then a
+        // traversal and random accesses.
+        run("production/" + entry.name, n + 1, "iterations",
+            [&entry, n]()
+            {
+                Production production (entry.lsys, n);
+            });
+        Production production (entry.lsys, n);
+        run("production_cursor/" + entry.name, n_symbols, "symbols",
+            [&production, n]()
+            {
+                unsigned long checksum = 0;
+                for (auto cursor = production.cursor(n); !cursor.is_done(); cursor.next())
+                {
+                    checksum += cursor.symbol();
+                }
+                sink = checksum;
+            });
+        constexpr int n_accesses = 1000;
+        run("production_symbol_at/" + entry.name, n_accesses, "symbols",
+            [&production, n]()
+            {
+                unsigned long checksum = 0;
+                auto size = production.size(n);
+                for (int i = 0; i < n_accesses; ++i)
+                {
+                    checksum += production.symbol_at(n, size / n_accesses * i);
+                }
+                sink = checksum;
+            });
+
+        // The rules are expanded during the interpretation: the derivation
+        // cached in 'derived' is not used.
+        InterpretationMap map = entry.map;
+        auto [vertices, iterations, max_iteration] = compute_vertices(derived, map, entry.params);
+        double n_vertices = vertices.size();
+        run("compute_vertices/" + entry.name, n_vertices, "vertices",
+            [&derived, &map, &entry]()
+            {
+                compute_vertices(derived, map, entry.params);
+            });
+
+        auto box = geometry::bounding_box(vertices);
+
+        // The statistics predicted without the vertices, with and without
+        // the bounding box.
+        run("compute_statistics/" + entry.name, n_vertices, "vertices",
+            [&entry, &map]()
+            {
+                compute_statistics(entry.lsys, map, entry.params);
+            });
+        run("compute_statistics_counts/" + entry.name, n_vertices, "vertices",
+            [&entry, &map]()
+            {
+                compute_statistics(entry.lsys, map, entry.params, false);
+            });
+
+        // The adaptive interpretation of the drawing fitting a window 1000
+        // pixels wide.
+        double min_extent = std::max(box.width, box.height) / 1000.;
+        double n_adaptive = std::get<0>(compute_vertices_adaptive(entry.lsys, map, entry.params, min_extent)).size();
+        run("compute_vertices_adaptive/" + entry.name, n_adaptive, "vertices",
+            [&entry, &map, min_extent]()
+            {
+                compute_vertices_adaptive(entry.lsys, map, entry.params, min_extent);
+            });
+
+        // The interpretation restricted to a sixteenth of the drawing.
+        sf::FloatRect region {box.left + box.width / 2, box.top + box.height / 2,
+                              box.width / 4, box.height / 4};
+        double n_restricted = std::get<0>(compute_vertices_adaptive(entry.lsys, map, entry.params, 0, region)).size();
+        run("compute_vertices_restricted/" + entry.name, n_restricted, "vertices",
+            [&entry, &map, region]()
+            {
+                compute_vertices_adaptive(entry.lsys, map, entry.params, 0, region);
+            });
+        std::vector<std::pair<std::string, std::shared_ptr<colors::VertexPainter>>> painters
+        {
+            {"Constant", std::make_shared<colors::VertexPainterConstant>()},
+            {"Iteration", std::make_shared<colors::VertexPainterIteration>()},
+            {"Linear", std::make_shared<colors::VertexPainterLinear>()},
+            {"Radial", std::make_shared<colors::VertexPainterRadial>()},
+            {"Random", std::make_shared<colors::VertexPainterRandom>()},
+            {"Sequential", std::make_shared<colors::VertexPainterSequential>()},
+            {"Composite", std::make_shared<colors::VertexPainterComposite>()},
+        };
+        for (auto& [name, painter] : painters)
+        {
+            run("paint/" + name + "/" + entry.name, n_vertices, "vertices",
+                [&painter = painter, &vertices = vertices, &iterations = iterations, max_iteration = max_iteration, box]()
+                {
+                    painter->paint_vertices(vertices, iterations, max_iteration, box);
+                });
+        }
+
+        run("bounding_box/" + entry.name, n_vertices, "vertices",
+            [&vertices = vertices]()
+            {
+                geometry::bounding_box(vertices);
+            });
+        run("sub_boxes/" + entry.name, n_vertices, "vertices",
+            [&vertices = vertices]()
+            {
+                geometry::sub_boxes(vertices, 8);
+            });
+
+        SavedView view {entry.name, entry.lsys, entry.params, entry.map};
+        std::string saved;
+        {
+            std::ostringstream oss;
+            {
+                cereal::JSONOutputArchive archive (oss);
+                archive(cereal::make_nvp("LSystemView", view));
+            }
+            saved = oss.str();
+        }
+        run("save/" + entry.name, 1, "files",
+            [&view]()
+            {
+                std::ostringstream oss;
+                cereal::JSONOutputArchive archive (oss);
+                archive(cereal::make_nvp("LSystemView", view));
+            });
+        run("load/" + entry.name, 1, "files",
+            [&saved]()
+            {
+                std::istringstream iss (saved);
+                cereal::JSONInputArchive archive (iss);
+                SavedView loaded;
+                archive(loaded);
+            });
+
+        // Binary save files of a LSystemView, with or without the embedded
+        // geometry: a load without geometry includes its materialization (the
+        // derivation and the interpretation).
+        procgui::LSystemView lsys_view (entry.name,
+                                        std::make_shared<LSystem>(entry.lsys),
+                                        std::make_shared<InterpretationMap>(entry.map),
+                                        std::make_shared<DrawingParameters>(entry.params));
+        lsys_view.materialize();
+        run("duplicate/" + entry.name, 1, "views",
+            [&lsys_view]()
+            {
+                lsys_view.duplicate();
+            });
+        for (bool embed_geometry : {false, true})
+        {
+            std::string suffix = embed_geometry ? "_geometry/" : "/";
+            std::string binary;
+            {
+                std::ostringstream oss;
+                lsys_view.save_file(oss, procgui::LSystemView::SaveFormat::Binary, embed_geometry);
+                binary = oss.str();
+            }
+            run("save_binary" + suffix + entry.name, 1, "files",
+                [&lsys_view, embed_geometry]()
+                {
+                    std::ostringstream oss;
+                    lsys_view.save_file(oss, procgui::LSystemView::SaveFormat::Binary, embed_geometry);
+                });
+            run("load_binary" + suffix + entry.name, 1, "files",
+                [&binary]()
+                {
+                    std::istringstream iss (binary);
+                    procgui::LSystemView::load_file(iss).materialize();
+                });
+        }
+    }
+
+    // Scene files of 'n_views' views cycling through the files of 'saves':
+    // the geometries not embedded are computed in parallel at loading.
+    void bench_scene(const std::vector<Entry>& saves, std::size_t n_views)
+    {
+        if (saves.empty() || std::string("load_scene").find(filter) == std::string::npos)
+        {
+            return;
+        }
+
+        std::vector<procgui::LSystemView> views;
+        for (std::size_t i = 0; i < n_views; ++i)
+        {
+            const auto& entry = saves[i % saves.size()];
+            views.emplace_back(entry.name,
+                               std::make_shared<LSystem>(entry.lsys),
+                               std::make_shared<InterpretationMap>(entry.map),
+                               std::make_shared<DrawingParameters>(entry.params));
+            views.back().materialize();
+        }
+        for (auto format : {procgui::LSystemView::SaveFormat::JSON, procgui::LSystemView::SaveFormat::Binary})
+        {
+            bool is_json = format == procgui::LSystemView::SaveFormat::JSON;
+            std::string scene;
+            {
+                std::ostringstream oss;
+                procgui::LSystemView::save_scene(oss, views, format, !is_json);
+                scene = oss.str();
+            }
+            run(std::string("load_scene") + (is_json ? "/" : "_geometry/") + std::to_string(n_views),
+                n_views, "files",
+                [&scene]()
+                {
+                    std::istringstream iss (scene);
+                    for (auto& view : procgui::LSystemView::load_scene(iss))
+                    {
+                        view.materialize();
+                    }
+                });
+        }
+    }
+}
+
+namespace
+{
+    // An observer of the DrawingParameters, like a LSystemView.
+    class ParamsObserver : public Observer<DrawingParameters>
+    {
+    public:
+        explicit ParamsObserver(const std::shared_ptr<DrawingParameters>& params)
+            : Observer<DrawingParameters>(params)
+            {
+                add_callback([this](){++n_notifications;});
+            }
+
+        void observe(const std::shared_ptr<DrawingParameters>& params)
+            {
+                set_target(params);
+                add_callback([this](){++n_notifications;});
+            }
+
+        unsigned long n_notifications {0};
+    };
+
+    // The notifications and the connection churn (like the copies and the
+    // moves of the views) of a scene of 'n_views' views observing the same
+    // DrawingParameters. Neither should allocate.
+    void bench_signals(std::size_t n_views)
+    {
+        auto params = std::make_shared<DrawingParameters>();
+        auto other = std::make_shared<DrawingParameters>();
+        std::vector<std::unique_ptr<ParamsObserver>> observers;
+        for (std::size_t i = 0; i < n_views; ++i)
+        {
+            observers.push_back(std::make_unique<ParamsObserver>(params));
+        }
+
+        auto suffix = "/" + std::to_string(n_views);
+        run("signal_notify" + suffix, n_views, "calls",
+            [&params]()
+            {
+                params->set_step(params->get_step() + 1);
+            });
+        run("signal_connect" + suffix, 2 * n_views, "connections",
+            [&observers, &params, &other]()
+            {
+                for (auto& observer : observers)
+                {
+                    observer->observe(other);
+                    observer->observe(params);
+                }
+            });
+    }
+}
+
+namespace
+{
+    // The identifiers and the scene of 'n_views' views: a view is erased and
+    // inserted again, like a deletion followed by a paste, and every view is
+    // accessed by its Handle, like the picking.
+    void bench_registry(std::size_t n_views)
+    {
+        auto suffix = "/" + std::to_string(n_views);
+        UniqueId ids;
+        std::vector<int> used;
+        for (std::size_t i = 0; i < n_views; ++i)
+        {
+            used.push_back(ids.get_id());
+        }
+        run("unique_id" + suffix, 1, "ids",
+            [&ids, &used]()
+            {
+                ids.free_id(used.back());
+                used.back() = ids.get_id();
+            });
+
+        // The construction of the views is skipped if not needed.
+        if (("registry_churn" + suffix).find(filter) == std::string::npos &&
+            ("registry_lookup" + suffix).find(filter) == std::string::npos)
+        {
+            return;
+        }
+        procgui::SceneRegistry registry;
+        std::vector<procgui::SceneRegistry::Handle> handles;
+        for (std::size_t i = 0; i < n_views; ++i)
+        {
+            handles.push_back(registry.insert(procgui::LSystemView(ext::sf::Vector2d(10. * i, 0.))));
+        }
+        std::size_t next = 0;
+        run("registry_churn" + suffix, 1, "views",
+            [&registry, &handles, &next]()
+            {
+                auto& handle = handles[next];
+                next = (next + 7919) % handles.size();
+                auto view = std::move(*registry.get(handle));
+                registry.erase(handle);
+                handle = registry.insert(std::move(view));
+            });
+        run("registry_lookup" + suffix, handles.size(), "handles",
+            [&registry, &handles]()
+            {
+                for (auto handle : handles)
+                {
+                    registry.get(handle)->is_selected();
+                }
+            });
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1)
+    {
+        filter = argv[1];
+    }
+
+    auto entries = load_saves("saves");
+    auto saves = entries;
+    auto curves = classic_curves();
+    entries.insert(end(entries), begin(curves), end(curves));
+
+    std::printf("%-48s %13s %15s %24s %14s\n", "benchmark", "", "time/run", "throughput", "peak heap");
+    for (const auto& entry : entries)
+    {
+        bench_entry(entry);
+    }
+
+    bench_scene(saves, 500);
+    bench_signals(5000);
+    bench_registry(10000);
+
+    // 'ru_maxrss' is in kilobytes on Linux.
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::printf("\nPeak resident memory: %.2f MiB\n", usage.ru_maxrss / 1024.);
+
+    return 0;
+}
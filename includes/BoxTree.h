@@ -0,0 +1,102 @@
+#ifndef BOX_TREE_H
+#define BOX_TREE_H
+
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "cereal/access.hpp"
+#include "geometry.h"
+#include "helper_cereal.h"
+
+namespace geometry
+{
+    // Static bounding volume hierarchy over a set of boxes, each box
+    // representing an item (a segment, a LSystemView, ...) by its index.
+    //
+    // The tree is built once, top-down, by splitting the items at the median
+    // of the longest axis: it is balanced and its depth is in O(log n). A
+    // modification of the items requires a new tree.
+    //
+    // Note: Contrary to 'sf::Rect::intersects()', boxes with a null width or
+    // height are correctly handled (see 'geometry::overlap()').
+    class BoxTree
+    {
+    public:
+        // Empty tree.
+        BoxTree() = default;
+        
+        // Build the tree of 'boxes'. The item 'i' has the box 'boxes[i]'.
+        // Complexity in time is in O(n log n), n being the number of boxes.
+        explicit BoxTree(const std::vector<sf::FloatRect>& boxes);
+
+        // The number of items.
+        std::size_t size() const;
+
+        // Call 'visit(i)' for each item 'i' whose box overlaps 'area'.
+        template<typename F>
+        void query(const sf::FloatRect& area, F&& visit) const;
+
+        // Find the item closest to 'point' whose distance is at most
+        // 'max_distance'. 'distance(i)' must return the distance between the
+        // item 'i' and 'point', which must be greater or equal to the distance
+        // between its box and 'point'.
+        // Returns the index of the item and its distance, or the size of the
+        // tree and an infinite distance if there is no such item.
+        template<typename D>
+        std::pair<std::size_t, float> nearest(const sf::Vector2f& point,
+                                              float max_distance,
+                                              D&& distance) const;
+
+    private:
+        // A node is a leaf if 'count' is not null: its items are
+        // 'items_[first, first+count)'. Otherwise, its children are the next
+        // node and the node 'second'.
+        struct Node
+        {
+            sf::FloatRect box;
+            std::uint32_t first;
+            std::uint32_t count;
+            std::uint32_t second;
+        };
+
+        // Build recursively the node of the items 'items_[first, last)'.
+        // Returns the index of the node.
+        std::uint32_t build(std::uint32_t first, std::uint32_t last);
+
+        // The distance between 'point' and 'box'. Null if 'point' is inside.
+        static float distance_to_box(const sf::Vector2f& point, const sf::FloatRect& box);
+
+        // Maximum number of items in a leaf.
+        static constexpr std::uint32_t LEAF_SIZE = 8;
+
+        // Maximum depth of the tree: the tree is balanced, a stack of this
+        // size is sufficient for any number of items.
+        static constexpr std::size_t MAX_DEPTH = 64;
+
+        std::vector<Node> nodes_ {};
+
+        // The indices of the items, ordered by leaf, and their boxes.
+        std::vector<std::uint32_t> items_ {};
+        std::vector<sf::FloatRect> boxes_ {};
+
+        // Serialization, only for binary archives: the tree is saved as is
+        // and is not built again at loading.
+        friend class cereal::access;
+
+        template<class Archive>
+        void save (Archive& ar, const std::uint32_t) const;
+
+        template<class Archive>
+        void load (Archive& ar, const std::uint32_t);
+    };
+}
+
+#include "BoxTree.tpp"
+
+
+#endif // BOX_TREE_H
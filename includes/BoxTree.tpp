@@ -0,0 +1,158 @@
+namespace geometry
+{
+    template<class Archive>
+    void BoxTree::save (Archive& ar, const std::uint32_t) const
+    {
+        std::vector<sf::FloatRect> node_boxes (nodes_.size());
+        std::vector<std::uint32_t> node_indices (3 * nodes_.size());
+        for (std::size_t i = 0; i < nodes_.size(); ++i)
+        {
+            node_boxes[i] = nodes_[i].box;
+            node_indices[3*i] = nodes_[i].first;
+            node_indices[3*i+1] = nodes_[i].count;
+            node_indices[3*i+2] = nodes_[i].second;
+        }
+        ext::sf::save_rects(ar, node_boxes);
+        ar(node_indices, items_);
+        ext::sf::save_rects(ar, boxes_);
+    }
+
+    template<class Archive>
+    void BoxTree::load (Archive& ar, const std::uint32_t)
+    {
+        std::vector<sf::FloatRect> node_boxes;
+        std::vector<std::uint32_t> node_indices;
+        ext::sf::load_rects(ar, node_boxes);
+        ar(node_indices, items_);
+        ext::sf::load_rects(ar, boxes_);
+
+        // The indices and the depth are checked: a corrupted file must not
+        // lead to out-of-bounds accesses in 'query()' and 'nearest()'. The
+        // children of a node are always after it.
+        bool valid = node_indices.size() == 3 * node_boxes.size() &&
+                     items_.size() == boxes_.size();
+        nodes_.resize(node_boxes.size());
+        std::vector<std::size_t> depth (nodes_.size(), 0);
+        for (std::size_t i = 0; valid && i < nodes_.size(); ++i)
+        {
+            nodes_[i] = {node_boxes[i], node_indices[3*i], node_indices[3*i+1], node_indices[3*i+2]};
+            const auto& node = nodes_[i];
+            if (node.count > 0)
+            {
+                valid = node.first <= items_.size() && node.count <= items_.size() - node.first;
+            }
+            else
+            {
+                valid = node.second > i + 1 && node.second < nodes_.size() && depth[i] + 2 < MAX_DEPTH;
+                if (valid)
+                {
+                    depth[i+1] = std::max(depth[i+1], depth[i] + 1);
+                    depth[node.second] = std::max(depth[node.second], depth[i] + 1);
+                }
+            }
+        }
+        for (std::size_t i = 0; valid && i < items_.size(); ++i)
+        {
+            valid = items_[i] < boxes_.size();
+        }
+        if (!valid)
+        {
+            nodes_.clear();
+            items_.clear();
+            boxes_.clear();
+            throw cereal::Exception("Invalid BoxTree");
+        }
+    }
+
+    template<typename F>
+    void BoxTree::query(const sf::FloatRect& area, F&& visit) const
+    {
+        if (nodes_.empty())
+        {
+            return;
+        }
+        
+        std::array<std::uint32_t, MAX_DEPTH> stack;
+        std::size_t top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const auto& node = nodes_[stack[--top]];
+            if (!overlap(node.box, area))
+            {
+                continue;
+            }
+            
+            if (node.count > 0)
+            {
+                for (auto i = node.first; i < node.first + node.count; ++i)
+                {
+                    if (overlap(boxes_[items_[i]], area))
+                    {
+                        visit(static_cast<std::size_t>(items_[i]));
+                    }
+                }
+            }
+            else
+            {
+                auto index = static_cast<std::uint32_t>(&node - nodes_.data());
+                stack[top++] = node.second;
+                stack[top++] = index + 1;
+            }
+        }
+    }
+
+    template<typename D>
+    std::pair<std::size_t, float> BoxTree::nearest(const sf::Vector2f& point,
+                                                   float max_distance,
+                                                   D&& distance) const
+    {
+        std::size_t best = size();
+        float best_distance = std::numeric_limits<float>::infinity();
+        if (nodes_.empty())
+        {
+            return {best, best_distance};
+        }
+
+        // Depth-first search, visiting the closest child first and pruning the
+        // nodes farther than the best item found.
+        std::array<std::uint32_t, MAX_DEPTH> stack;
+        std::size_t top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            auto index = stack[--top];
+            const auto& node = nodes_[index];
+            float node_distance = distance_to_box(point, node.box);
+            if (node_distance > max_distance || node_distance >= best_distance)
+            {
+                continue;
+            }
+
+            if (node.count > 0)
+            {
+                for (auto i = node.first; i < node.first + node.count; ++i)
+                {
+                    float d = distance(static_cast<std::size_t>(items_[i]));
+                    if (d <= max_distance && d < best_distance)
+                    {
+                        best = items_[i];
+                        best_distance = d;
+                    }
+                }
+            }
+            else
+            {
+                auto first = index + 1;
+                auto second = node.second;
+                if (distance_to_box(point, nodes_[first].box) > distance_to_box(point, nodes_[second].box))
+                {
+                    std::swap(first, second);
+                }
+                stack[top++] = second;
+                stack[top++] = first;
+            }
+        }
+        return {best, best_distance};
+    }
+}
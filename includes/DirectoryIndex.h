@@ -0,0 +1,102 @@
+#ifndef DIRECTORY_INDEX_H
+#define DIRECTORY_INDEX_H
+
+
+#include <chrono>
+#include <condition_variable>
+#include <experimental/filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Sorted list of the regular files of a directory, maintained in the
+// background.
+//
+// The directory is read once at construction, then a thread checks its
+// modification time every 'period' and reads it again only if it has changed
+// (a file was created, removed or renamed). The GUI can then display the list
+// at each frame without any access to the file system.
+//
+// Each file has a precomputed sort key (its lowercase name): the list is
+// sorted case-insensitively and can be filtered without any conversion.
+//
+// The destructor stops the thread.
+class DirectoryIndex
+{
+public:
+    struct File
+    {
+        std::string filename;
+        // Lowercase 'filename'.
+        std::string sort_key;
+
+        bool operator==(const File& other) const;
+    };
+    using Files = std::vector<File>;
+
+    static constexpr std::chrono::milliseconds DEFAULT_PERIOD {500};
+
+    explicit DirectoryIndex(const std::experimental::filesystem::path& directory,
+                            std::chrono::milliseconds period = DEFAULT_PERIOD);
+    ~DirectoryIndex();
+
+    // An index is neither copyable nor movable: the thread refers to it.
+    DirectoryIndex(const DirectoryIndex&) = delete;
+    DirectoryIndex(DirectoryIndex&&) = delete;
+    DirectoryIndex& operator=(const DirectoryIndex&) = delete;
+    DirectoryIndex& operator=(DirectoryIndex&&) = delete;
+
+    // The latest list of the files, sorted by 'sort_key'. The list is never
+    // modified: it is replaced at each change.
+    std::shared_ptr<const Files> get_files() const;
+
+    // False if the directory could not be read at the latest reading.
+    bool is_valid() const;
+
+    // Incremented each time the list or its validity changes. Used to cache
+    // data computed from the list.
+    unsigned long get_generation() const;
+
+    // Read the directory again as soon as possible in the background, even
+    // if its modification time has not changed.
+    void refresh();
+
+    // The indices of the files of 'files' whose name contains 'pattern',
+    // case-insensitively.
+    static std::vector<std::size_t> filter(const Files& files, const std::string& pattern);
+
+    // The lowercase 'filename'.
+    static std::string sort_key(const std::string& filename);
+
+private:
+    // The loop of the thread: check the modification time of the directory
+    // every 'period_' until 'stop_'.
+    void poll();
+
+    // Read the directory and publish the list if it has changed.
+    void scan();
+
+    const std::experimental::filesystem::path directory_;
+    const std::chrono::milliseconds period_;
+
+    // The modification time of the directory at the latest reading. Only
+    // accessed by the thread (and the constructor before it starts).
+    std::experimental::filesystem::file_time_type last_write_time_;
+
+    // Protect all the following attributes.
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    std::shared_ptr<const Files> files_;
+    bool is_valid_ {false};
+    unsigned long generation_ {0};
+    bool refresh_requested_ {false};
+    bool stop_ {false};
+
+    // Last attribute: started once everything else is initialized.
+    std::thread thread_;
+};
+
+
+#endif // DIRECTORY_INDEX_H
@@ -0,0 +1,149 @@
+#ifndef DISK_CACHE_H
+#define DISK_CACHE_H
+
+
+#include <cstdint>
+#include <experimental/filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include <gsl/gsl>
+
+#include "LSystem.h"
+#include "InterpretationMap.h"
+#include "DrawingParameters.h"
+
+// Persistent cache of the heavy computations between sessions: the vertices of
+// the turtle interpretation of the LSystems.
+//
+// Each entry is a file of the cache directory, named after a 64-bit hash of the
+// state of the models (see 'key()'). The hash only locates the entry: the entry
+// also stores the canonical bytes of the state of the models, its identity,
+// which are compared on lookup so a hash collision is never served. An entry is
+// a list of blocks of raw bytes, each one aligned in the file. The entries are read with
+// a read-only memory mapping: the blocks point directly into the mapped file,
+// without any parsing.
+//
+// The total size of the directory is bounded: the least recently used entries
+// are evicted when a new entry is stored. The entries are written in a
+// temporary file then renamed, so a concurrent reader never sees a partial
+// entry.
+//
+// The blocks are in the native representation of the machine: the cache
+// directory must not be shared between different architectures.
+//
+// The cache is disabled until 'open()' is called.
+//
+// DiskCache is a singleton implemented as a static class. It is thread-safe.
+class DiskCache
+{
+public:
+    // Delete the constructor to implement the singleton.
+    DiskCache() = delete;
+
+    // A read-only memory mapping of an entry.
+    class Entry
+    {
+    public:
+        // Map the file at 'path'. Throws 'std::runtime_error' if the file can
+        // not be mapped or is not a valid entry of 'key' and 'identity'.
+        Entry(const std::experimental::filesystem::path& path, std::uint64_t key,
+              const std::string& identity);
+        ~Entry();
+        Entry(Entry&& other);
+        Entry& operator=(Entry&& other);
+        Entry(const Entry&) = delete;
+        Entry& operator=(const Entry&) = delete;
+
+        std::size_t n_blocks() const;
+
+        // The 'i'-th block as an array of 'T'. Only valid during the lifetime
+        // of the Entry.
+        // Exception:
+        //   - Precondition: 'i' < 'n_blocks()'.
+        //   - Precondition: the size of the block is a multiple of 'sizeof(T)'.
+        template<typename T>
+        gsl::span<const T> block(std::size_t i) const;
+
+    private:
+        void unmap();
+
+        const char* data_ {nullptr};
+        std::size_t size_ {0};
+        // The offset and the size of each block in the file.
+        std::vector<std::pair<std::size_t, std::size_t>> blocks_ {};
+    };
+
+    using Block = gsl::span<const gsl::byte>;
+
+    // Enable the cache in 'directory', created if necessary. The total size of
+    // the entries is bounded by 'max_bytes'. The computations smaller than
+    // 'min_entry_bytes' are faster to do again than to read from the disk and
+    // are not stored.
+    static void open(const std::experimental::filesystem::path& directory,
+                     std::uintmax_t max_bytes = DEFAULT_MAX_BYTES,
+                     std::size_t min_entry_bytes = DEFAULT_MIN_ENTRY_BYTES);
+
+    // Disable the cache. The entries stay on the disk.
+    static void close();
+
+    static bool is_open();
+
+    // Remove all the entries.
+    static void clear();
+
+    // The entry of 'key', if there is one and it was stored with the same
+    // 'identity'. Marks the entry as recently used.
+    static std::optional<Entry> find(std::uint64_t key, const std::string& identity);
+
+    // Store 'blocks' as the entry of 'key' and 'identity', if the cache is
+    // open and their total size is large enough. Evicts the least recently
+    // used entries if the cache is too large.
+    static void store(std::uint64_t key, const std::string& identity,
+                      const std::vector<Block>& blocks);
+
+    // Identities and keys
+    // The 64-bit hash of 'identity'.
+    static std::uint64_t key(const std::string& identity);
+
+    // The vertices of the interpretation of 'lsys' by 'map' with 'params':
+    // the axiom, the sorted rules, the predecessors of the iterations, the
+    // sorted orders of the map, the angles, the step, the number of
+    // iterations and 'INTERPRETER_VERSION'. The starting position is not a
+    // part of it: the vertices are computed around the origin.
+    static std::string geometry_identity(const LSystem& lsys,
+                                         const drawing::InterpretationMap& map,
+                                         const drawing::DrawingParameters& params);
+    static std::uint64_t geometry_key(const LSystem& lsys,
+                                      const drawing::InterpretationMap& map,
+                                      const drawing::DrawingParameters& params);
+
+    // The version of the turtle interpretation. Must be incremented when the
+    // same models are interpreted into different vertices, so the entries of
+    // the previous interpretation are not used anymore.
+    static constexpr std::uint32_t INTERPRETER_VERSION = 1;
+
+    static constexpr std::uintmax_t DEFAULT_MAX_BYTES = std::uintmax_t(1) << 30;
+    static constexpr std::size_t DEFAULT_MIN_ENTRY_BYTES = 1 << 20;
+
+private:
+    // Remove the least recently used entries until the total size of the
+    // entries is at most 'max_bytes_'. 'mutex_' must be locked.
+    static void evict();
+
+    // The file of the entry of 'key'.
+    static std::experimental::filesystem::path entry_path(std::uint64_t key);
+
+    // Protect all the following attributes.
+    static std::mutex mutex_;
+    // Empty if the cache is disabled.
+    static std::experimental::filesystem::path directory_;
+    static std::uintmax_t max_bytes_;
+    static std::size_t min_entry_bytes_;
+};
+
+#include "DiskCache.tpp"
+
+
+#endif // DISK_CACHE_H
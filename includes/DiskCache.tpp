@@ -0,0 +1,11 @@
+template<typename T>
+gsl::span<const T> DiskCache::Entry::block(std::size_t i) const
+{
+    Expects(i < blocks_.size());
+    auto [offset, size] = blocks_[i];
+    Expects(size % sizeof(T) == 0);
+
+    // The blocks are aligned in the file and the mapping is page-aligned.
+    return {reinterpret_cast<const T*>(data_ + offset),
+            static_cast<std::ptrdiff_t>(size / sizeof(T))};
+}
@@ -20,9 +20,25 @@ namespace drawing
     // initialized and modified via getters and setters, there are no invariant.
     // During an interpretation, this structure will not be
     // modified.
+    //
+    // Each setter notifies the observers after setting the field returned by
+    // 'get_last_modified()': the observers can update only what depends on
+    // this field. If several fields are modified in the same transaction (see
+    // 'Observable'), it is 'Several'.
     class DrawingParameters : public Observable
     {
     public:
+        // The fields of the parameters.
+        enum Field
+        {
+            StartingPosition,
+            StartingAngle,
+            DeltaAngle,
+            Step,
+            NIter,
+            Several
+        };
+
         DrawingParameters() = default;
         DrawingParameters(const ext::sf::Vector2d& starting_position);
         DrawingParameters(const ext::sf::Vector2d& starting_position,
@@ -38,10 +54,10 @@ namespace drawing
         double get_delta_angle() const;
         double get_step() const;
         int get_n_iter() const;
+        // The field modified by the latest setter.
+        Field get_last_modified() const;
 
         // Setters
-        // The starting position is only used when rendering the LSystem, so it
-        // does not 'notify()' to avoid re-calculating for nothing.
         void set_starting_position(const ext::sf::Vector2d starting_position); 
         void set_starting_angle(double starting_angle);
         void set_delta_angle(double delta_angle);
@@ -49,6 +65,9 @@ namespace drawing
         void set_n_iter(int n_iter);
         
     private:
+        // Set 'last_modified_' to 'field' and notify the observers.
+        void modified(Field field);
+
         // The starting position and angle of the Turtle.
         ext::sf::Vector2d starting_position_ { 0, 0 };
         double starting_angle_ { 0 };
@@ -66,6 +85,10 @@ namespace drawing
         // The number of iterations done by the L-system.
         int n_iter_ { 0 };
 
+        // The field modified by the latest setter, read by the observers
+        // during the notification.
+        Field last_modified_ { StartingPosition };
+
     private:
         // Serialization
         friend class cereal::access;
@@ -79,13 +102,15 @@ namespace drawing
                    CEREAL_NVP(n_iter_));
             }
         
+        // The observers are notified once, after the loading.
         template <class Archive>
         void load (Archive& ar, const std::uint32_t)
             {
+                Transaction transaction (*this);
                 ar(starting_angle_, delta_angle_, step_, n_iter_);
                 starting_angle_ = math::degree_to_rad(starting_angle_);
                 delta_angle_ = math::degree_to_rad(delta_angle_);
-                
+                modified(Several);
             }
 
     };
@@ -5,6 +5,7 @@
 #include <unordered_map>
 
 #include "cereal/cereal.hpp"
+#include "cereal/types/string.hpp"
 #include "cereal/types/unordered_map.hpp"
 
 #include "DrawingParameters.h"
@@ -112,30 +113,48 @@ namespace drawing
         void save (Archive& ar, const std::uint32_t) const
             {
                 // Custom save to have a pretty map between predecessors and
-                // orders.
-                for(const auto& i : rules_)
-                    ar(cereal::make_nvp(std::string()+i.first, i.second));
+                // orders. Binary archives do not have names: the map is saved
+                // in the standard way.
+                if constexpr (cereal::traits::is_text_archive<Archive>::value)
+                {
+                    for(const auto& i : rules_)
+                        ar(cereal::make_nvp(std::string()+i.first, i.second));
+                }
+                else
+                {
+                    ar(rules_);
+                }
             }
 
+        // The observers are notified once, after the loading.
         template<class Archive>
         void load (Archive& ar, const std::uint32_t)
             {
-                // Complex loading as we do not save the 'map' in a standard
-                // way.
-                rules_.clear();
-
-                auto hint = rules_.begin();
-                while(true)
+                Transaction transaction (*this);
+                if constexpr (cereal::traits::is_text_archive<Archive>::value)
                 {
-                    const auto namePtr = ar.getNodeName();
-
-                    if(!namePtr)
-                        break;
-
-                    std::string key = namePtr;
-                    Order value; ar(value);
-                    hint = rules_.emplace_hint(hint, key.at(0), std::move(value));
+                    // Complex loading as we do not save the 'map' in a
+                    // standard way.
+                    rules_.clear();
+
+                    auto hint = rules_.begin();
+                    while(true)
+                    {
+                        const auto namePtr = ar.getNodeName();
+
+                        if(!namePtr)
+                            break;
+
+                        std::string key = namePtr;
+                        Order value; ar(value);
+                        hint = rules_.emplace_hint(hint, key.at(0), std::move(value));
+                    }
+                }
+                else
+                {
+                    ar(rules_);
                 }
+                notify();
             }
     };
 
@@ -8,6 +8,7 @@
 #include <algorithm>
 
 #include "cereal/cereal.hpp"
+#include "cereal/types/string.hpp"
 #include "cereal/types/unordered_map.hpp"
 
 #include "Observable.h"
@@ -135,9 +136,20 @@ public:
     //   - Ensures coherence of 'production_rules
     //   - Throw in case of allocation problem.
     //   - Throw at '.at()' if code is badly refactored.
+    //
+    // The drawings do not derive the LSystem (the rules are expanded during
+    // the interpretation, see 'drawing::compute_vertices()'): 'produce()' is
+    // the reference derivation, and 'Production' its compressed equivalent.
     std::tuple<std::string, std::vector<int>, int> produce(int n);
        
 private:
+    // Reset the caches to the axiom. In a transaction, only flag them as
+    // outdated: they are reset once at the commit (or at the next
+    // 'produce()').
+    void invalidate_caches();
+    void reset_caches();
+    void on_commit() override;
+
 
     friend class cereal::access;
     
@@ -149,13 +161,16 @@ private:
                cereal::make_nvp("iteration_predecessor", iteration_predecessors_));
         }
     
+    // The observers are notified once, after the loading.
     template <class Archive>
     void load (Archive& ar, const std::uint32_t)
         {
-            ar(cereal::make_nvp("axiom", production_cache_[0]),
+            Transaction transaction (*this);
+            std::string axiom;
+            ar(cereal::make_nvp("axiom", axiom),
                cereal::make_nvp("production_rules", rules_),
                cereal::make_nvp("iteration_predecessor", iteration_predecessors_));
-            iteration_count_cache_[0] = {std::vector<int>(production_cache_.at(0).size(), 0), 0};
+            set_axiom(axiom);
         }
 
     // The predecessors indicating than, at their next derivation, the iteration
@@ -172,6 +187,10 @@ private:
     // The cache of all computed iteration values. The second element in the pair
     // is the maximum number of iteration for this iteration.
     std::unordered_map<int, std::pair<std::vector<int>, int>> iteration_count_cache_ = {};
+
+    // True if the caches must be reset: the rules were modified in a
+    // transaction.
+    bool caches_outdated_ = false;
 };
 
 #endif
@@ -4,11 +4,12 @@
 
 #include <chrono>
 #include <optional>
-#include <list>
 
 #include "SFML/Graphics.hpp"
 
+#include "BoxTree.h"
 #include "LSystemView.h"
+#include "SceneRegistry.h"
 
 namespace controller
 {
@@ -27,27 +28,39 @@ namespace controller
         static bool has_priority();
 
         // Handle 'event' for the 'views'.
-        static void handle_input(std::list<procgui::LSystemView>& views, const sf::Event& event);
+        static void handle_input(procgui::SceneRegistry& views, const sf::Event& event);
 
         // Handle the dragging behaviour.
-        static void handle_delta(sf::Vector2f delta);
+        static void handle_delta(procgui::SceneRegistry& views, sf::Vector2f delta);
 
         // Interact with a menu when right-clicking on a LSystemView (cloning,
         // duplicating, ...) 
-        static void right_click_menu(std::list<procgui::LSystemView>& views);
+        static void right_click_menu(procgui::SceneRegistry& views);
 
         // Getters
         static const std::optional<procgui::LSystemView>& saved_view();
-        static const procgui::LSystemView* under_mouse();
+        // The view of 'views' below the mouse, nullptr if there is nothing.
+        static const procgui::LSystemView* under_mouse(const procgui::SceneRegistry& views);
         static bool is_clone();
 
     private:
-        // Delete the LSystemView with identifier 'id' in 'views'
-        static void delete_view(std::list<procgui::LSystemView>& views, int id);
+        // Delete the LSystemView of 'handle' in 'views'
+        static void delete_view(procgui::SceneRegistry& views, procgui::SceneRegistry::Handle handle);
+
+        // Rebuild 'views_tree_' if the bounding boxes of the LSystemViews
+        // changed since the last build.
+        static void update_views_tree(procgui::SceneRegistry& views);
+
+        // The spatial index of the screen-space bounding boxes of the
+        // LSystemViews: the item 'i' is 'tree_views_[i]', in the order of the
+        // registry. Built at 'tree_generation_'.
+        static geometry::BoxTree views_tree_;
+        static std::vector<procgui::SceneRegistry::Handle> tree_views_;
+        static unsigned long tree_generation_;
         
-        // The LSystemView below the mouse. nullptr if there is
-        // nothing. Non-owning pointer.
-        static procgui::LSystemView* under_mouse_;
+        // The LSystemView below the mouse. A default Handle if there is
+        // nothing.
+        static procgui::SceneRegistry::Handle under_mouse_;
 
         // When copying or duplicating in a right-click, we save the LSystemView
         // in this variable. optional<> is used to initialize an empty variable
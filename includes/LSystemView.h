@@ -2,15 +2,32 @@
 #define LSYSTEM_VIEW
 
 
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <istream>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
 #include "cereal/cereal.hpp"
-#include "cereal/access.hpp"
+#include "cereal/types/string.hpp"
 
 #include "geometry.h"
+#include "helper_cereal.h"
+#include "BoxTree.h"
+#include "DiskCache.h"
 #include "DrawingParameters.h"
 #include "LSystemBuffer.h"
 #include "InterpretationMapBuffer.h"
 #include "UniqueColor.h"
 #include "UniqueId.h"
+#include "UpdateScheduler.h"
+#include "WorkerPool.h"
 #include "VertexPainterWrapper.h"
 
 namespace procgui
@@ -25,12 +42,25 @@ namespace procgui
     //     boxes.
     //
     // Invariant:
-    //     - The 'vertices_' and 'iteration_of_vertices_' must correspond to the
-    //     LSystem, InterpretationMap, and DrawingParameters.
-    //     - The 'vertices_' are at any time painted with VertexPainter.
-    //     - The 'bounding_box_' and 'sub_boxes_' must correspond with the
-    //     'vertices_'.
+    //     - Once materialized, the vertices of 'geometry_' and their
+    //     iterations must correspond to the LSystem, InterpretationMap, and
+    //     DrawingParameters.
+    //     - The vertices are at any time painted with VertexPainter.
+    //     - The bounding boxes, the spatial indices and the level-of-detail
+    //     pyramid of 'geometry_' must correspond with its vertices.
     //     - Each instance as a unique 'id_' and 'color_id_'
+    //     - The invariants on the vertices are respected after each call to
+    //     'update()': the notifications of the models are coalesced in
+    //     'scheduler_' and applied once per frame. The vertices are then
+    //     computed in the background and the previous ones are kept until
+    //     the new ones are received.
+    //
+    // The geometry is materialized lazily: a view constructed without
+    // geometry does not compute anything until its first 'update()' (in
+    // 'draw()' once its predicted drawing is in the viewport), an explicit
+    // 'materialize()', or a 'prefetch()'. A view which is never displayed
+    // never derives its LSystem, and the copies and moves of a new view do
+    // not copy any vertex.
     //
     // Note:
     //    - LSystemView contain a shared ownership of the LSystem and the
@@ -75,41 +105,426 @@ namespace procgui
         // Getters
         // Correctly translated to screen-space bounding_box.
         sf::FloatRect get_bounding_box() const;
+        // The screen-space bounding box of a view not materialized yet,
+        // predicted by 'drawing::compute_statistics()' without computing its
+        // vertices. 'get_bounding_box()' once materialized.
+        sf::FloatRect get_predicted_bounding_box();
         const drawing::DrawingParameters& get_parameters() const;
         const LSystemBuffer& get_lsystem_buffer() const;
         const InterpretationMapBuffer& get_interpretation_buffer() const;
         const colors::VertexPainterWrapper& get_vertex_painter_wrapper() const;
         int get_id() const;
         sf::Color get_color() const;
+        const UpdateScheduler& get_scheduler() const;
         // Translation transform to correct screen-space position of the
-        // LSystem. 
+        // LSystem. While a preview is displayed in progressive mode, it is
+        // also scaled to the estimated size of the computed iteration.
         sf::Transform get_transform() const;
 
-        // Compute the vertices of the turtle interpretation of the LSystem.
+        // Compute synchronously the vertices of the turtle interpretation of
+        // the LSystem and their bounding boxes.
         void compute_vertices();
+
+        // An exact interpretation predicted to have more than 'MAX_VERTICES'
+        // vertices (see 'drawing::compute_statistics()') is refused: the
+        // geometry is empty. Returns the predicted number of vertices if the
+        // current geometry was refused, 0 otherwise.
+        static constexpr std::uint64_t MAX_VERTICES = std::uint64_t(1) << 27;
+        std::uint64_t get_refused_vertices() const;
+
+        // True if the geometry was computed at least once.
+        bool is_materialized() const;
+        // Compute synchronously and paint the geometry if it was never
+        // computed. If it is already being computed in the background, wait
+        // for the result instead.
+        void materialize();
+        // Start computing the geometry in the background if it was never
+        // computed: it will be received by 'update()' or 'materialize()'.
+        void prefetch();
+        // Paint the vertices with the VertexPainter.
         void paint_vertices();
 
-        // Draw the vertices.
+        // Discard the background computations of all the views and wait for
+        // the running ones. Must be called before the end of 'main()': the
+        // workers use static objects (the Profiler for example) which are
+        // destroyed before them. The views must not be updated
+        // afterwards.
+        static void shutdown_workers();
+
+        // Apply the pending modifications of the models: start a background
+        // computation and/or repaint the vertices if necessary, and receive
+        // the result of a finished background computation. Called once per
+        // frame in 'draw()'.
+        void update();
+
+        // True if the vertices are being computed in the background.
+        bool is_computing() const;
+
+        // In progressive mode, during a background computation, the view
+        // immediately displays the previous iteration scaled to the estimated
+        // size of the new one, then the partial vertices of the new iteration
+        // as they are computed.
+        //
+        // The preview is the geometry already displayed, not the highest
+        // iteration cached by the LSystem: displaying a cached production
+        // would need its complete interpretation on the GUI thread, and the
+        // rules are expanded during the interpretation so no production is
+        // cached anyway.
+        bool is_progressive() const;
+        void set_progressive(bool progressive);
+
+        // In adaptive mode, the symbols whose drawing would be smaller than
+        // 'ADAPTIVE_PIXELS' pixels at the zoom of the latest 'draw()' are not
+        // expanded further (see 'drawing::compute_vertices_adaptive()'). The
+        // drawing is interpreted again when the zoom changes by more than a
+        // factor 2.
+        static constexpr double ADAPTIVE_PIXELS = 1.;
+        bool is_adaptive() const;
+        void set_adaptive(bool adaptive);
+
+        // In restricted mode, only the part of the drawing around the
+        // viewport of the latest 'draw()' is computed (see
+        // 'drawing::compute_vertices_adaptive()'): deep zooms are computed at
+        // a cost proportional to the visible part. The drawing is interpreted
+        // again when the viewport leaves the computed region. The bounding
+        // box is then the bounding box of the computed part.
+        bool is_restricted() const;
+        void set_restricted(bool restricted);
+
+        // Draw the vertices. A view not yet materialized is not updated while
+        // its predicted bounding box is outside of the viewport.
         void draw(sf::RenderTarget &target);
 
         // Getter to is_selected_.
         bool is_selected() const;
 
-        // Check if 'click' is inside one of the correctly translated
-        // 'bounding_box_'. 
+        // Check if 'click' is closer than 'PICKING_TOLERANCE' to one of the
+        // visible segments of the drawing. Complexity in time is in O(log n),
+        // n being the number of vertices.
+        static constexpr float PICKING_TOLERANCE = 5.f;
         bool is_inside(const sf::Vector2f& click) const;
 
+        // Incremented each time the screen-space bounding box of any
+        // LSystemView may have changed (modification, creation, destruction,
+        // ...). Used to cache spatial indices of the LSystemViews.
+        static unsigned long bounds_generation();
+
         // Select the view.
         void select();
 
+        // The formats of the save files. The JSON format is human-readable
+        // and only contains the models. The binary format (a cereal portable
+        // binary archive) can also embed the computed geometry: loading it is
+        // then a copy instead of a derivation and an interpretation.
+        enum class SaveFormat
+        {
+            JSON,
+            Binary
+        };
+
+        // Save the view in 'os' in 'format'. 'embed_geometry' is ignored in
+        // the JSON format.
+        void save_file(std::ostream& os, SaveFormat format, bool embed_geometry = false) const;
+
+        // Load a view saved with 'save_file()' in any format. Throws a
+        // 'cereal::Exception' if 'is' is not a valid save file.
+        static LSystemView load_file(std::istream& is);
+
+        // Save all the 'views' as a scene in 'os' in 'format', with their
+        // starting positions. 'embed_geometry' is ignored in the JSON format.
+        static void save_scene(std::ostream& os,
+                               const std::vector<LSystemView>& views,
+                               SaveFormat format,
+                               bool embed_geometry = false);
+
+        // True if 'is' starts with a scene saved with 'save_scene()' in any
+        // format. The position of 'is' is restored.
+        static bool is_scene(std::istream& is);
+
+        // Load a scene saved with 'save_scene()' in any format. The views
+        // without embedded geometry are returned unmaterialized and their
+        // geometries are prefetched in parallel by the background workers.
+        // Throws a 'cereal::Exception' if 'is' is not a valid scene.
+        static std::vector<LSystemView> load_scene(std::istream& is);
+
                 
     private:
+        struct Geometry;
+
+        // Construct the view with an already computed 'geometry', or with a
+        // geometry to materialize if there is none.
+        LSystemView(const std::string& name,
+                    std::shared_ptr<LSystem> lsys,
+                    std::shared_ptr<drawing::InterpretationMap> map,
+                    std::shared_ptr<drawing::DrawingParameters> params,
+                    std::shared_ptr<colors::VertexPainterWrapper> painter,
+                    std::optional<Geometry>&& geometry);
+
         void update_callbacks();
+
+        // The bounding boxes of the consecutive chunks of 'CHUNK_SIZE'
+        // vertices: only the chunks inside the viewport are drawn.
+        static constexpr std::size_t CHUNK_SIZE = 4096;
+
+        // A level of the level-of-detail pyramid: the vertices simplified with
+        // 'tolerance' (in the local coordinates) and their chunks.
+        struct LevelOfDetail
+        {
+            float tolerance {0.f};
+            std::vector<sf::Vertex> vertices {};
+            std::vector<sf::FloatRect> chunk_boxes {};
+        };
+        using LevelsOfDetail = std::shared_ptr<const std::vector<LevelOfDetail>>;
+        static constexpr int MAX_LOD_LEVELS = 16;
+        static constexpr float LOD_BASE_TOLERANCE = 1.f;
+        // The maximal difference of the channels of two consecutive vertices
+        // of a color run (see 'geometry::simplify()').
+        static constexpr int LOD_COLOR_TOLERANCE = 8;
+
+        // A background build of the level-of-detail pyramid, shared by the
+        // copies of a geometry. The worker only holds a weak reference to the
+        // snapshot of the painted vertices: once no geometry waits for the
+        // build, the snapshot is released and the build is cancelled.
+        struct LodBuild
+        {
+            std::shared_future<LevelsOfDetail> result {};
+            std::shared_ptr<const std::vector<sf::Vertex>> vertices {};
+            std::shared_ptr<std::atomic<bool>> cancelled {std::make_shared<std::atomic<bool>>(false)};
+
+            ~LodBuild();
+        };
+
+        // The result of the turtle interpretation and the bounding boxes.
+        struct Geometry
+        {
+            // The vertices of the View and their iteration count.
+            std::vector<sf::Vertex> vertices {};
+            std::vector<int> iteration_of_vertices {};
+            int max_iteration {0};
+            // The DiskCache entry of a geometry computed in a previous
+            // session. The iteration counts are read directly in its mapping
+            // and 'iteration_of_vertices' is empty. The vertices are painted
+            // and rotated in place, so they are still copied.
+            std::shared_ptr<const DiskCache::Entry> cache_entry {};
+
+            // The iteration count of each vertex.
+            gsl::span<const int> iterations() const
+                {
+                    return cache_entry ? cache_entry->block<int>(1) : gsl::make_span(iteration_of_vertices);
+                }
+            // The global bounding box of the drawing. It is a "raw" bounding
+            // box: its position is fixed. The rendering at the correct
+            // position as well as getters are correctly translated with
+            // 'get_transform()'.
+            sf::FloatRect bounding_box {};
+            // The bounding volume hierarchy of the segments of the drawing:
+            // the item 'i' is the segment between the vertices 'i' and 'i+1'.
+            geometry::BoxTree segment_tree {};
+            std::vector<sf::FloatRect> chunk_boxes {};
+            // The level-of-detail pyramid. 'vertices' is the level 0 and is
+            // not in 'lod_levels'. Built in the background after each
+            // painting to preserve the color runs: not set until
+            // 'lod_pending' is received. The pyramid only depends on the
+            // vertices, so it is received even if the geometry is shared.
+            LevelsOfDetail lod_levels {};
+            std::shared_ptr<LodBuild> lod_pending {};
+            // The iteration of the LSystem interpreted, and the step and the
+            // starting angle of the interpretation.
+            int n_iter {0};
+            double step {0};
+            double starting_angle {0};
+            // The minimal extent of the adaptive interpretation, 0 for an
+            // exact interpretation.
+            double min_extent {0};
+            // The region of the restricted interpretation, in the coordinates
+            // of the turtle. Not set for a complete interpretation.
+            std::optional<sf::FloatRect> region {};
+            // The predicted number of vertices of a refused interpretation,
+            // 0 if it was not refused.
+            std::uint64_t refused_vertices {0};
+            // False if this is the partial geometry of an unfinished
+            // computation.
+            bool is_complete {true};
+        };
+
+        // The partial geometry of a background computation, shared between
+        // the worker and the view.
+        struct PartialGeometry
+        {
+            std::mutex mutex {};
+            std::optional<Geometry> geometry {};
+        };
+
+        // A background computation of the geometry. The views with the same
+        // 'instance_identity()' share a single computation: the first one to
+        // receive it takes its result and registers it as an instance, the
+        // other ones adopt this instance. The computation is cancelled
+        // cooperatively once no view waits for it anymore.
+        struct Computation
+        {
+            std::future<Geometry> result {};
+            std::shared_ptr<std::atomic<bool>> cancelled {std::make_shared<std::atomic<bool>>(false)};
+            // The 'instance_identity()' of the models, if it is shared.
+            std::string identity {};
+
+            ~Computation();
+        };
+
+        // Compute the geometry of the models. It does not access any attribute
+        // so it can be called from any thread as long as the models are not
+        // modified during the computation. Returns early if 'cancelled' is set.
+        // If 'partial' is set, the partial geometry is regularly published into
+        // it.
+        // If 'min_extent' is not 0, the interpretation is adaptive. If
+        // 'region' is set, it is restricted to 'region'.
+        static Geometry compute_geometry(const LSystem& lsys,
+                                         const drawing::InterpretationMap& map,
+                                         const drawing::DrawingParameters& params,
+                                         double min_extent,
+                                         const std::optional<sf::FloatRect>& region,
+                                         const std::atomic<bool>* cancelled = nullptr,
+                                         PartialGeometry* partial = nullptr);
+
+        // Compute the bounding boxes and the spatial indices of the vertices
+        // of 'geometry'.
+        static void compute_boxes(Geometry& geometry);
+
+        // Replace the vertices and the bounding boxes with 'geometry'.
+        void set_geometry(Geometry&& geometry);
+        void set_geometry(std::shared_ptr<Geometry> geometry);
+
+        // The geometry of 'geometry_' to modify: copied first if it is
+        // shared with another view.
+        Geometry& edit_geometry();
+
+        // Share the geometry of 'other' whose models are equal to the models
+        // of this view.
+        void share_geometry(const LSystemView& other);
+
+        // The empty geometry shared by the views not yet materialized and the
+        // moved-from views.
+        static const std::shared_ptr<Geometry>& empty_geometry();
+
+        // The identity of the models of the painted geometry independent of
+        // the placement: the canonical bytes of the LSystem, the
+        // InterpretationMap and the DrawingParameters except the starting
+        // position (see 'DiskCache::geometry_identity()'). Adaptive
+        // geometries are instances only of the views whose minimal extents
+        // are within the same power of 2.
+        std::string instance_identity() const;
+
+        // The key of 'identity' and of the VertexPainterWrapper. It only
+        // locates an instance or a computation: their identities are compared
+        // before sharing them. Restricted geometries are not instances.
+        std::uint64_t instance_key(const std::string& identity) const;
+
+        // The minimal extent of the adaptive interpretation at the current
+        // zoom, 0 if the view is not adaptive.
+        double min_extent() const;
+
+        // The region of the restricted interpretation around the current
+        // viewport, not set if the view is not restricted.
+        std::optional<sf::FloatRect> region() const;
+
+        // False if the geometry must be interpreted again for the current
+        // zoom or viewport in adaptive or restricted mode.
+        bool is_interpreted_for_view() const;
+
+        // Replace the geometry with the instance registered for the current
+        // models if there is one. Returns true if it was replaced.
+        bool adopt_instance();
+
+        // Register the geometry as the instance of the current models if it
+        // is complete and up-to-date.
+        void register_instance();
+
+        // Unregister the instances painted by 'painter': they are outdated.
+        static void forget_instances(const colors::VertexPainterWrapper* painter);
+
+        // Start computing the geometry in the background, or wait for the
+        // computation of another view with the same models. Cancel the
+        // previous computation if there is one.
+        void start_computation();
+
+        // Apply the modifications of the step and the starting angle to the
+        // complete geometry: the vertices are scaled and rotated around the
+        // origin of the turtle instead of being interpreted again.
+        void transform_geometry();
+
+        // Stop waiting for the background computation and forget its result.
+        // It is cancelled if no other view waits for it.
+        void cancel_computation();
+
+        // If the background computation is finished, replace the geometry
+        // with its result and paint it, unless another view already did it
+        // for the same models: its instance is adopted instead. In
+        // progressive mode, do the same with the latest partial geometry.
+        void receive_computation();
+
+        // Estimate the scale between the drawing of the iteration 'from' and
+        // the drawing of the iteration 'to' with the extents of the previously
+        // computed iterations ('iteration_extents_'). Returns 1 if there is no
+        // estimation.
+        float estimate_scale(int from, int to) const;
+
+        // Start building the level-of-detail pyramid of the painted vertices
+        // in the background.
+        void build_lod_levels();
+
+        // The level-of-detail pyramid of 'vertices'. Each level is simplified
+        // from 'vertices' with twice the tolerance of the previous one, so
+        // its error is at most its tolerance. Returns early if 'cancelled' is
+        // set.
+        static std::vector<LevelOfDetail> compute_lod_levels(const std::vector<sf::Vertex>& vertices,
+                                                             const std::atomic<bool>* cancelled = nullptr);
+
+        // Receive the level-of-detail pyramid of 'geometry' if it is built.
+        static void receive_lod_levels(Geometry& geometry);
+
+        // The callback of the DrawingParameters: only the modified field is
+        // taken into account. The position only changes the transform, the
+        // step and the starting angle transform the current geometry, and
+        // the other fields need a new interpretation.
+        void params_modified();
+
+        // Forget 'iteration_extents_' if the drawing parameters other than the
+        // number of iterations were modified.
+        void check_iteration_extents();
         
         // The managers of unique identifiers and colors for each instance of
         // LSystemView. 
         static UniqueId unique_ids_;
         static colors::UniqueColor unique_colors_;
+
+        // See 'bounds_generation()'.
+        static unsigned long bounds_generation_;
+
+        // The threads computing the geometry of every LSystemView.
+        static WorkerPool workers_;
+
+        // The registry of the instanced geometries: the views whose models
+        // only differ by their starting position (for example the duplicates)
+        // share a single geometry, drawn with different transforms. Maps the
+        // 'instance_key()' of the models to the latest geometry painted for
+        // them, as long as a view uses it. Only accessed by the GUI thread.
+        struct Instance
+        {
+            std::weak_ptr<Geometry> geometry {};
+            // The painter of the instance: the key only contains its address,
+            // which may be reused by another painter once it is destroyed.
+            std::weak_ptr<colors::VertexPainterWrapper> painter {};
+            // The 'instance_identity()' of the models: different models may
+            // have the same key.
+            std::string identity {};
+        };
+        static std::unordered_map<std::uint64_t, Instance> instances_;
+        // The registry of the running computations, by the 'instance_key()'
+        // of their models. The progressive and restricted computations are
+        // not shared: they depend on the view.
+        static std::unordered_map<std::uint64_t, std::weak_ptr<Computation>> computations_;
+        // The expired instances are removed when the registry reaches this
+        // size.
+        static std::size_t next_instances_sweep_;
         // Unique identifier for each instance. Used in procgui.
         int id_;
         // Unique color for each instance. Linked to 'id_'.
@@ -126,57 +541,196 @@ namespace procgui
         // shared_ptr<InterpretationMap> with the associated Observable.
         InterpretationMapBuffer interpretation_buff_;
 
-        // The vertices of the View and their iteration count. Computed at each
-        // modification.
-        std::vector<sf::Vertex> vertices_;
-        std::vector<int> iteration_of_vertices_;
-        int max_iteration_;
-        
-        // The global bounding box of the drawing. It is a "raw" bounding box:
-        // its position is fixed. The rendering at the correct position as well
-        // as getters are correctly translated with 'get_transform()'.
-        sf::FloatRect bounding_box_;
-
-        // The sub-bounding boxes of the drawing: a more precise way to decide
-        // if a mouse click select this View.
-        static constexpr int MAX_SUB_BOXES = 8;
-        std::vector<sf::FloatRect> sub_boxes_;
+        // The painted geometry of the View. Computed at each modification.
+        // Copy-on-write: it is shared by the copies of the view (copy,
+        // 'duplicate()', 'clone()', clipboard) and is never modified while it
+        // is shared. A view modifying it takes its own copy with
+        // 'edit_geometry()', and a new geometry simply replaces it.
+        std::shared_ptr<Geometry> geometry_;
 
         // True if the window is selected.
         bool is_selected_;
 
-        // Serialization
-        friend class cereal::access;
+        // False until the first complete geometry is received.
+        bool is_materialized_;
+
+        // True if the vertices are painted with the current state of the
+        // VertexPainter.
+        bool is_painted_;
+
+        // Coalesce the notifications of the models and apply them once per
+        // frame.
+        UpdateScheduler scheduler_;
+
+        // The background computation, possibly shared with other views. Null
+        // if there is no computation running.
+        std::shared_ptr<Computation> pending_;
+
+        // True if the progressive mode is activated.
+        bool is_progressive_;
 
+        // True if the adaptive mode and the restricted mode are activated.
+        bool is_adaptive_;
+        bool is_restricted_;
+
+        // The size of a pixel and the viewport in the coordinates of the
+        // scene at the latest 'draw()'. Respectively 0 and empty before the
+        // first one.
+        double pixel_size_;
+        sf::FloatRect viewport_;
+
+        // The bounding box of the drawing predicted by
+        // 'drawing::compute_statistics()', used to cull the views not yet
+        // materialized. Reset when the models are modified.
+        std::optional<sf::FloatRect> predicted_box_;
+
+        // The partial geometry of the background computation in progressive
+        // mode.
+        std::shared_ptr<PartialGeometry> partial_;
+
+        // The iteration of the LSystem currently displayed. -1 if it is a
+        // partial geometry.
+        int displayed_iteration_;
+
+        // The scale applied to the vertices when displaying a preview.
+        float preview_scale_;
+
+        // The size (the largest side of the bounding box) of the drawing of
+        // each iteration already computed, used to estimate 'preview_scale_'.
+        // Only valid for the 'extents_parameters_' (starting angle, delta angle,
+        // and step) and the current LSystem and InterpretationMap.
+        std::map<int, float> iteration_extents_;
+        std::array<double, 3> extents_parameters_;
+
+        // The models of a view as they are saved, with its geometry. The
+        // models are shared with the saved view: nothing is copied.
+        struct SavedView
+        {
+            std::string name {};
+            std::shared_ptr<LSystem> lsys {};
+            std::shared_ptr<drawing::DrawingParameters> params {};
+            std::shared_ptr<drawing::InterpretationMap> map {};
+            // The starting position is saved in the scenes but not in the
+            // files of a single view.
+            bool with_position {true};
+            // At saving, the view whose geometry is embedded (binary archives
+            // only) if it is set.
+            const LSystemView* geometry_of {nullptr};
+            // At loading, the embedded geometry.
+            std::optional<Geometry> geometry {};
+
+            template<class Archive>
+            void save (Archive& ar, const std::uint32_t) const;
+
+            template<class Archive>
+            void load (Archive& ar, const std::uint32_t);
+        };
+
+        // The SavedView of this view, embedding its geometry if
+        // 'embed_geometry' is set and the geometry is up-to-date.
+        SavedView to_saved_view(bool embed_geometry, bool with_position) const;
+
+        // Construct the view of 'saved', with its embedded geometry or with the
+        // geometry computed from its models.
+        static LSystemView from_saved_view(SavedView&& saved);
+
+        // Serialization of the computed geometry, embedded in the binary save
+        // files. The vertices are saved painted but are painted again at
+        // loading: the VertexPainter is not saved.
         template<class Archive>
-        void save (Archive& ar, const std::uint32_t) const
+        void save_geometry (Archive& ar) const
             {
-                ar(cereal::make_nvp("name", name_),
-                   cereal::make_nvp("LSystem", *Observer<LSystem>::get_target()),
-                   cereal::make_nvp("DrawingParameters", *Observer<drawing::DrawingParameters>::get_target()),
-                   cereal::make_nvp("Interpretation Map", *Observer<drawing::InterpretationMap>::get_target()));
+                const auto& box = geometry_->bounding_box;
+                std::vector<int> mapped_iterations;
+                if (geometry_->cache_entry)
+                {
+                    auto iterations = geometry_->iterations();
+                    mapped_iterations.assign(iterations.begin(), iterations.end());
+                }
+                const auto& iterations = geometry_->cache_entry ? mapped_iterations : geometry_->iteration_of_vertices;
+                ext::sf::save_vertices(ar, geometry_->vertices);
+                ext::sf::save_rects(ar, geometry_->chunk_boxes);
+                ar(iterations, geometry_->max_iteration,
+                   box.left, box.top, box.width, box.height,
+                   geometry_->segment_tree, displayed_iteration_);
             }
 
         template<class Archive>
-        void load (Archive& ar, const std::uint32_t)
+        static Geometry load_geometry (Archive& ar)
             {
-                std::string name;
-                LSystem lsys;
-                drawing::DrawingParameters params;
-                drawing::InterpretationMap map;
-
-                ar(name,
-                   cereal::make_nvp("LSystem", lsys),
-                   cereal::make_nvp("DrawingParameters", params),
-                   cereal::make_nvp("Interpretation Map", map));
+                Geometry geometry;
+                ext::sf::load_vertices(ar, geometry.vertices);
+                ext::sf::load_rects(ar, geometry.chunk_boxes);
+                auto& box = geometry.bounding_box;
+                ar(geometry.iteration_of_vertices, geometry.max_iteration,
+                   box.left, box.top, box.width, box.height,
+                   geometry.segment_tree, geometry.n_iter);
+                if (geometry.iteration_of_vertices.size() != geometry.vertices.size() ||
+                    geometry.chunk_boxes.size() != (geometry.vertices.size() + CHUNK_SIZE - 1) / CHUNK_SIZE ||
+                    geometry.segment_tree.size() != std::max<std::size_t>(geometry.vertices.size(), 1) - 1)
+                {
+                    throw cereal::Exception("Inconsistent geometry");
+                }
+                return geometry;
+            }
+    };
 
-                *this = LSystemView(name,
-                                    std::make_shared<LSystem>(lsys),
-                                    std::make_shared<drawing::InterpretationMap>(map),
-                                    std::make_shared<drawing::DrawingParameters>(params));
+    template<class Archive>
+    void LSystemView::SavedView::save (Archive& ar, const std::uint32_t) const
+    {
+        ar(cereal::make_nvp("name", name),
+           cereal::make_nvp("LSystem", *lsys),
+           cereal::make_nvp("DrawingParameters", *params),
+           cereal::make_nvp("Interpretation Map", *map));
+        if (with_position)
+        {
+            auto position = params->get_starting_position();
+            ar(cereal::make_nvp("x", position.x),
+               cereal::make_nvp("y", position.y));
+        }
+        if constexpr (!cereal::traits::is_text_archive<Archive>::value)
+        {
+            ar(geometry_of != nullptr);
+            if (geometry_of)
+            {
+                geometry_of->save_geometry(ar);
+            }
+        }
+    }
 
+    template<class Archive>
+    void LSystemView::SavedView::load (Archive& ar, const std::uint32_t)
+    {
+        lsys = std::make_shared<LSystem>();
+        params = std::make_shared<drawing::DrawingParameters>();
+        map = std::make_shared<drawing::InterpretationMap>();
+        ar(name,
+           cereal::make_nvp("LSystem", *lsys),
+           cereal::make_nvp("DrawingParameters", *params),
+           cereal::make_nvp("Interpretation Map", *map));
+        if (with_position)
+        {
+            ext::sf::Vector2d position;
+            ar(cereal::make_nvp("x", position.x),
+               cereal::make_nvp("y", position.y));
+            params->set_starting_position(position);
+        }
+        if constexpr (!cereal::traits::is_text_archive<Archive>::value)
+        {
+            bool has_geometry;
+            ar(has_geometry);
+            if (has_geometry)
+            {
+                geometry = load_geometry(ar);
+                if (geometry->n_iter != params->get_n_iter())
+                {
+                    throw cereal::Exception("Geometry inconsistent with the models");
+                }
+                geometry->step = params->get_step();
+                geometry->starting_angle = params->get_starting_angle();
             }
-    };
+        }
+    }
 }
 
 #endif
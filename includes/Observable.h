@@ -2,8 +2,11 @@
 #define OBSERVABLE_H
 
 
-#include <unordered_map>
-#include <functional>
+#include <cstddef>
+#include <list>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 #include "gsl/gsl"
 
@@ -11,20 +14,97 @@
 //
 // Any class which inherit from 'Observable' can be observed by 'Observer<>' or
 // simple functions.
-// In case of observers classes, they must be added with 'add_observer()' and
-// removed with 'remove_observer()'. These method are classically called in a
-// RAII fashion. See the 'Observer<>' class for more information.
-// In case of simple functions, 'remove_observer()' is not necessary.
+// In case of observers classes, each one owns a 'Slot' connected to the
+// Observable: the slots are the nodes of an intrusive list, so connecting,
+// replacing the callback and disconnecting never allocate. A slot is
+// disconnected at its destruction. See the 'Observer<>' class for more
+// information.
+// In case of simple functions, they are added with 'add_observer()' and
+// removed with 'remove_observer()': the Observable owns their slot.
 // Every time the child class is modified, 'notify()' must be called to inform
 // the observers of the change.
+//
+// Several modifications can be grouped in a transaction: the observers are
+// then notified only once, at the commit, instead of after each
+// modification. The child classes can also defer their own costly work (like
+// the invalidation of a cache) until the commit with 'on_commit()'.
 class Observable
 {
 public:
-    // The type of function called after each 'notify()' call.
-    using callback = std::function<void()>;
+    // The function called after each 'notify()' call: a callable 'void()'
+    // stored inline, without allocation. Only the small trivially copyable
+    // functors are accepted, like the lambdas capturing 'this' or a few
+    // references.
+    class Callback
+    {
+    public:
+        static constexpr std::size_t CAPACITY = 3 * sizeof(void*);
+
+        Callback() = default;
+        Callback(std::nullptr_t) {}
+
+        template<typename F,
+                 typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Callback> &&
+                                             !std::is_same_v<std::decay_t<F>, std::nullptr_t>>>
+        Callback(F f)
+            {
+                static_assert(sizeof(F) <= CAPACITY, "A Callback must be small: capture 'this' instead");
+                static_assert(alignof(F) <= alignof(void*), "A Callback must not be over-aligned");
+                static_assert(std::is_trivially_copyable_v<F> && std::is_trivially_destructible_v<F>,
+                              "A Callback must be trivially copyable: capture by reference");
+                new (storage_) F(f);
+                invoke_ = [](void* storage){(*static_cast<F*>(storage))();};
+            }
+
+        explicit operator bool() const
+            {
+                return invoke_ != nullptr;
+            }
+
+        void operator()() const
+            {
+                invoke_(storage_);
+            }
+
+    private:
+        alignas(void*) mutable unsigned char storage_[CAPACITY] {};
+        void (*invoke_)(void*) {nullptr};
+    };
+    using callback = Callback;
+
+    // The connection of a callback to an Observable. A Slot is a node of the
+    // intrusive list of its Observable: it is neither copyable nor movable.
+    class Slot
+    {
+    public:
+        Slot() = default;
+        ~Slot();
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+
+        // Connect to 'observable' with the callback 'f'. If the slot is
+        // already connected to 'observable', only the callback is replaced.
+        // Exception:
+        //  - Precondition: 'f' must not be a nullptr.
+        void connect(Observable& observable, Callback f);
+
+        // Disconnect from the current Observable, if any.
+        void disconnect();
+
+        bool is_connected() const;
+
+    private:
+        friend class Observable;
+
+        Observable* observable_ {nullptr};
+        Slot* previous_ {nullptr};
+        Slot* next_ {nullptr};
+        Callback callback_ {};
+    };
 
     Observable() = default;
-    // The rule-of-five is necessary as the 'observers_' must not be copied from
+    virtual ~Observable();
+    // The rule-of-five is necessary as the slots must not be copied from
     // an Observable to another (but can be moved).
     Observable(const Observable& other);
     Observable(Observable&& other);
@@ -40,17 +120,71 @@ public:
     //  - Precondition: 'id' must be a previously given identifier.
     void remove_observer(int id);
 
+    // True if at least a slot is connected.
+    bool has_observers() const;
+
+    // Start a transaction: until the matching 'commit_transaction()', the
+    // calls to 'notify()' are deferred. Transactions can be nested: only the
+    // outermost commit notifies the observers, once, and only if 'notify()'
+    // was called during the transaction.
+    void begin_transaction();
+
+    // End a transaction.
+    // Exception:
+    //  - Precondition: a transaction must have been started.
+    void commit_transaction();
+
+    // RAII guard starting a transaction at construction and committing it at
+    // destruction.
+    class Transaction
+    {
+    public:
+        explicit Transaction(Observable& observable);
+        ~Transaction();
+        Transaction(const Transaction&) = delete;
+        Transaction& operator=(const Transaction&) = delete;
+
+    private:
+        Observable& observable_;
+    };
+
 protected:
     // Notify all the observers. Must be called after each modification in the
-    // child class.
-    void notify() const;
+    // child class. Deferred until the commit inside a transaction.
+    void notify();
+
+    // True if a transaction is in progress.
+    bool in_transaction() const;
+
+    // True if 'notify()' was called in the current transaction.
+    bool is_notification_deferred() const;
+
+    // Called by the outermost commit, before notifying the observers, if
+    // 'notify()' was called during the transaction. The child classes
+    // override it to complete the work deferred during the transaction.
+    virtual void on_commit();
+
+private:
+    // Append 'slot' to the list, or unlink it.
+    void link(Slot& slot);
+    void unlink(Slot& slot);
+
+    // Disconnect all the slots.
+    void disconnect_all();
 
+    // The intrusive list of the connected slots, in connection order.
+    Slot* first_ { nullptr };
+    Slot* last_ { nullptr };
 
-    // A counter for the identifier of the next observer.
+    // The slots of the simple functions added with 'add_observer()'. The
+    // elements of a list are never moved: they can be linked.
     int id_ { 0 };
+    std::list<std::pair<int, Slot>> owned_slots_ { };
 
-    // The map of all callbacks.
-    std::unordered_map<int, callback> observers_ { };
+    // The depth of the nested transactions. Neither copied nor moved: a new
+    // Observable is never in a transaction.
+    int transaction_depth_ { 0 };
+    bool notification_deferred_ { false };
 };
 
 
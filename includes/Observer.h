@@ -31,31 +31,26 @@ public:
     Observer() = delete;
     Observer(const std::shared_ptr<T>& t)
         : target_(t)
-        , id_ { -1, false }
+        , slot_ {}
         {
         }
 
-    // An Observer can not be copied trivially: no callback would be send to the
-    // 'target_' but the id would be saved, making the destructor removing twice
-    // for the same id. Each child class must define these function taking care
-    // of calling 'add_callback()'.
+    // An Observer can not be copied trivially: its slot is linked in the list
+    // of the 'target_' and the callback usually refers to the copied
+    // object. Each child class must define these function taking care of
+    // calling 'add_callback()'.
     Observer(const Observer& other) = delete;
     Observer& operator=(const Observer& other) = delete;
     Observer(const Observer&& other) = delete;
     Observer& operator=(const Observer&& other) = delete;
 
 
-    // If the callback exists, remove it from the target observable. Else, do
-    // nothing. 
-    virtual ~Observer()
-        {
-            if (target_ && id_.second)
-            {
-                target_->remove_observer(id_.first);
-            }
-        }
+    // The slot disconnects itself from the target observable.
+    virtual ~Observer() = default;
 
-    // Add a callback to the target observable.
+    // Connect a callback to the target observable. If a callback is already
+    // connected, it is replaced in place: no allocation and no change of the
+    // order of the notifications.
     // Usually, the callback is a method from the child class. The destructor
     // assures that the method of a destructed object is never used. However,
     // due to the construction of 'add_callback()', any suitable function could
@@ -63,26 +58,15 @@ public:
     // you are doing.
     void add_callback(const Observable::callback& callback)
         {
-            if (target_ && id_.second)
+            if (target_)
             {
-                target_->remove_observer(id_.first);
-                id_.first = target_->add_observer(callback);
-            }
-            else if (target_)
-            {
-                id_.first = target_->add_observer(callback);
-                id_.second = true;
+                slot_.connect(*target_, callback);
             }
         }
     
     void set_target(const std::shared_ptr<T>& t)
         {
-            if (target_ && id_.second)
-            {
-                target_->remove_observer(id_.first);
-                id_.first = -1;
-                id_.second = false;
-            }
+            slot_.disconnect();
             target_ = t;
         }
 
@@ -95,9 +79,9 @@ private:
     // The target observable.
     std::shared_ptr<T> target_;
 
-    // The identifier of the registered callback.
-    // If the callback is not defined, the boolean will be false.
-    std::pair<int, bool> id_ { -1, false };
+    // The connection to 'target_'. Declared after 'target_': it is
+    // disconnected before the target is released.
+    Observable::Slot slot_ {};
 };
 
 
@@ -0,0 +1,182 @@
+#ifndef PRODUCTION_H
+#define PRODUCTION_H
+
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "LSystem.h"
+
+// The productions of a LSystem, up to the iteration 'max_n', accessed without
+// being derived.
+//
+// A production is entirely described by its derivation tree: the axiom is
+// derived into the successors of its symbols, which are derived into the
+// successors of their symbols, etc. The tree is compressed by the rules
+// themselves: two symbols derived the same number of times produce the same
+// string. So instead of storing the productions, 'Production' stores for each
+// symbol and each number of derivations 'g' the length of the string it
+// produces, and for each rule the prefix sums of the lengths of its successor.
+//
+// The symbol at a position of the iteration 'n' is then found by descending
+// the derivation tree from the axiom: at each level, a binary search in the
+// prefix sums gives the symbol of the successor containing the position. The
+// cost is O(n log(k)) with 'k' the length of the longest successor, and the
+// memory is O(max_n * sum(k)), whatever the length of the productions.
+//
+// Like 'LSystem::produce()', a symbol of the iteration 'n' is associated to
+// its iteration count: the number of its ancestors (or of its own identity
+// derivations for a terminal) whose symbol is one of the iteration
+// predecessors.
+//
+// A 'Production' is a snapshot of the LSystem at its construction: it is not
+// updated when the rules change.
+//
+// The lengths saturate at 'SATURATED': an iteration whose length does not fit
+// in 64 bits can be measured but not accessed.
+class Production
+{
+public:
+    static constexpr std::uint64_t SATURATED = std::numeric_limits<std::uint64_t>::max();
+
+    // A position in the iteration 'n', moving forward symbol by symbol.
+    //
+    // The Cursor keeps the path from the axiom to the current symbol: moving
+    // to the next symbol is O(1) amortized, and 'n' in the worst case.
+    //
+    // Invalidation:
+    //   - A Cursor refers to its Production: it is invalidated when the
+    //   Production is destroyed or moved.
+    class Cursor
+    {
+    public:
+        // True if the Cursor is past the last symbol.
+        bool is_done() const;
+
+        // The current symbol and its iteration count.
+        // Exception:
+        //  - Precondition: the Cursor must not be done.
+        char symbol() const;
+        int iteration() const;
+
+        // The position of the current symbol in the production.
+        std::uint64_t position() const;
+
+        // Move to the next symbol.
+        // Exception:
+        //  - Precondition: the Cursor must not be done.
+        void next();
+
+    private:
+        friend class Production;
+        Cursor(const Production& production, int n, std::uint64_t offset);
+
+        // An inner node of the path: the symbol 'symbol' derived 'generation'
+        // times, whose successor at 'child' is being visited.
+        struct Frame
+        {
+            int symbol;
+            int generation;
+            std::size_t child;
+            int iteration;
+        };
+
+        // Descend from the symbol 'symbol' derived 'generation' times with
+        // the iteration count 'iteration' to its first symbol.
+        void descend(int symbol, int generation, int iteration);
+
+        const Production* production_;
+        std::vector<Frame> path_ {};
+        std::uint64_t position_ {0};
+        std::uint64_t size_ {0};
+        int symbol_ {0};
+        int iteration_ {0};
+    };
+
+    // Compute the length tables of the iterations 0 to 'max_n' of 'lsys'.
+    // Exception:
+    //  - Precondition: 'max_n' must be positive.
+    Production(const LSystem& lsys, int max_n);
+
+    int get_max_iteration() const;
+
+    // The length of the iteration 'n', 'SATURATED' if it overflows.
+    // Exception:
+    //  - Precondition: 'n' must be in [0, max_n].
+    std::uint64_t size(int n) const;
+
+    // The symbol at position 'i' of the iteration 'n' and its iteration
+    // count.
+    // Exception:
+    //  - Precondition: 'n' must be in [0, max_n].
+    //  - Precondition: 'i' must be lesser than 'size(n)', which must not be
+    //  saturated.
+    char symbol_at(int n, std::uint64_t i) const;
+    int iteration_at(int n, std::uint64_t i) const;
+
+    // A Cursor at position 'offset' of the iteration 'n'. If 'offset' is
+    // 'size(n)', the Cursor is done.
+    // Exception:
+    //  - Precondition: 'n' must be in [0, max_n].
+    //  - Precondition: 'offset' must be lesser or equal than 'size(n)', which
+    //  must not be saturated.
+    Cursor cursor(int n, std::uint64_t offset = 0) const;
+
+    // The bounds of 'chunks' consecutive parts of the iteration 'n' of equal
+    // length (to one symbol): the part 'k' is [bounds[k], bounds[k+1]). Each
+    // part can then be iterated independently with 'cursor(n, bounds[k])'.
+    // Exception:
+    //  - Precondition: 'n' must be in [0, max_n] and 'size(n)' must not be
+    //  saturated.
+    //  - Precondition: 'chunks' must be strictly positive.
+    std::vector<std::uint64_t> split(int n, std::size_t chunks) const;
+
+private:
+    // The length of the string produced by the symbol 'symbol' derived
+    // 'generation' times.
+    std::uint64_t length(int symbol, int generation) const;
+
+    // The prefix sums of the lengths of the successor of 'symbol', each
+    // symbol being derived 'generation - 1' times: its size is the length of
+    // the successor plus one.
+    const std::uint64_t* prefixes(int symbol, int generation) const;
+
+    // The index of the successor of 'symbol' containing the position 'i',
+    // the symbol being derived 'generation' times. 'i' is made relative to
+    // this successor.
+    std::size_t find_child(int symbol, int generation, std::uint64_t& i) const;
+
+    // The index of the leaf symbol at position 'i' of the iteration 'n', and
+    // its iteration count.
+    std::pair<int, int> locate(int n, std::uint64_t i) const;
+
+    int max_n_;
+
+    // The symbols are indexed. The index 0 is the root: a virtual symbol whose
+    // successor is the axiom, so the iteration 'n' is the root derived 'n+1'
+    // times.
+    std::array<int, 256> index_ {};
+    std::vector<char> symbols_ {};
+    std::vector<bool> has_rule_ {};
+    std::vector<bool> is_counted_ {};
+
+    // The successor of the symbol 's' is
+    // '[children_[first_child_[s]], children_[first_child_[s+1]])'.
+    std::vector<int> children_ {};
+    std::vector<std::size_t> first_child_ {};
+
+    // 'lengths_[s * (max_n_ + 2) + g]' is the length of the symbol 's' derived
+    // 'g' times.
+    std::vector<std::uint64_t> lengths_ {};
+
+    // The prefix sums of the symbol 's' derived 'g' times (with 'g' at least
+    // 1) start at 'prefixes_[first_prefix_[s] + (g - 1) * (k + 1)]' with 'k'
+    // the length of its successor.
+    std::vector<std::uint64_t> prefixes_ {};
+    std::vector<std::size_t> first_prefix_ {};
+};
+
+
+#endif // PRODUCTION_H
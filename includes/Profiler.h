@@ -0,0 +1,143 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Scoped instrumentation of the application.
+//
+// A 'Profiler::Scope' measures the duration of its lifetime, the number of
+// bytes allocated by its thread during it, and an optional item count (symbols,
+// vertices, ...). The measures are recorded as 'Sample's, tagged with the
+// context (usually the identifier of a LSystemView) set on the thread by a
+// 'Profiler::Context'.
+//
+// The samples are kept for two usages:
+//   - The latest sample of each name for each context, for the statistics
+//   displayed in the GUI.
+//   - The 'MAX_SAMPLES' most recent samples, exported in the Chrome trace
+//   event format (chrome://tracing or https://ui.perfetto.dev).
+//
+// The allocations are only counted if 'PROFILER_COUNT_ALLOCATIONS' is defined
+// (as by 'make bench'): the global 'operator new' and 'operator delete' are
+// then replaced in 'Profiler.cpp'. Otherwise, the allocation functions are the
+// default ones and the memory statistics are 0.
+//
+// Recording a sample locks a mutex but does not allocate (except to grow the
+// storage of the samples): the names are not copied and the identifier of
+// each thread is computed once. A Scope can then be used at each frame.
+//
+// Profiler is a singleton implemented as a static class. It is thread-safe.
+class Profiler
+{
+public:
+    // Delete the constructor to implement the singleton.
+    Profiler() = delete;
+
+    // The context of the samples without any 'Context'.
+    static constexpr int NO_CONTEXT = -1;
+
+    // True if the allocations are counted.
+#if defined(PROFILER_COUNT_ALLOCATIONS)
+    static constexpr bool COUNTS_ALLOCATIONS = true;
+#else
+    static constexpr bool COUNTS_ALLOCATIONS = false;
+#endif
+
+    // A measure of a scope.
+    struct Sample
+    {
+        // Name of the scope. Must be a string literal.
+        const char* name;
+        int context;
+        // Start time since the start of the application.
+        std::chrono::microseconds start;
+        std::chrono::microseconds duration;
+        unsigned long items;
+        std::size_t allocated_bytes;
+        // Small identifier of the thread, in order of appearance.
+        int thread;
+    };
+
+    // Measure the lifetime of a scope. 'name' must be a string literal.
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name, unsigned long items = 0);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        // Set the number of items processed in the scope.
+        void set_items(unsigned long items);
+
+    private:
+        const char* name_;
+        unsigned long items_;
+        std::chrono::steady_clock::time_point start_;
+        std::size_t allocated_at_start_;
+    };
+
+    // Set the context of the samples of the current thread for the lifetime
+    // of this object, then restore the previous one.
+    class Context
+    {
+    public:
+        explicit Context(int context);
+        ~Context();
+        Context(const Context&) = delete;
+        Context& operator=(const Context&) = delete;
+
+    private:
+        int previous_;
+    };
+
+    // The latest sample named 'name' for 'context', if there is one.
+    static std::optional<Sample> latest(int context, std::string_view name);
+
+    // Write the recorded samples as a Chrome trace event JSON file.
+    static void export_chrome_trace(std::ostream& os);
+
+    // Forget all the samples.
+    static void clear();
+
+    // Memory statistics
+    // Number of bytes allocated by the current thread since its start.
+    static std::size_t thread_allocated_bytes();
+    // Number of bytes currently allocated by the application.
+    static std::size_t live_bytes();
+    // Maximum of 'live_bytes()' since the start of the application or the
+    // last call to 'reset_peak_bytes()'.
+    static std::size_t peak_bytes();
+    static void reset_peak_bytes();
+
+    // Maximum number of samples kept for the trace export.
+    static constexpr std::size_t MAX_SAMPLES = 1 << 16;
+
+private:
+    static void record(const Sample& sample);
+
+    // The small identifier of the current thread.
+    static int thread_index();
+
+    // The time origin of the samples.
+    static const std::chrono::steady_clock::time_point origin_;
+
+    // Protect all the following attributes.
+    static std::mutex mutex_;
+    static std::deque<Sample> samples_;
+    // The names are string literals: they are referred to without copy.
+    static std::map<std::pair<int, std::string_view>, Sample> latest_;
+    static int n_threads_;
+};
+
+
+#endif // PROFILER_H
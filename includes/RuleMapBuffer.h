@@ -148,6 +148,7 @@ namespace procgui
 
         // Apply the buffered instruction.
         // If 'instruction_' is nullptr, does nothing.
+        // The Target notifies its observers only once, after the instruction.
         void apply();
         
     private:
@@ -312,6 +312,9 @@ void RuleMapBuffer<Target>::apply()
 {
     if(instruction_)
     {
+        // An instruction can modify several rules of the Target: the
+        // observers are notified only once.
+        Observable::Transaction transaction (observer_target());
         instruction_();
         instruction_ = nullptr;
     }
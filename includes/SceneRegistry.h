@@ -0,0 +1,102 @@
+#ifndef SCENE_REGISTRY_H
+#define SCENE_REGISTRY_H
+
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "LSystemView.h"
+
+namespace procgui
+{
+    // The registry of the LSystemViews of the scene.
+    //
+    // The views are stored contiguously: iterating over the scene at each
+    // frame (drawing, picking) is cache-friendly. They are referred to by a
+    // 'Handle': the index of a slot, which stores the position of the view in
+    // the storage, and the generation of this slot. The generation is
+    // incremented each time a view is erased, so a Handle to an erased view is
+    // detected even if its slot is reused. Inserting, erasing and resolving a
+    // Handle are O(1).
+    //
+    // A view is erased by moving the last view into its place: the order of
+    // iteration is the order of insertion until the first erasure.
+    //
+    // Invalidation:
+    //   - A pointer, a reference or an iterator to a view is invalidated by
+    //   any insertion or erasure.
+    //   - A Handle stays valid until its view is erased.
+    class SceneRegistry
+    {
+    public:
+        static constexpr std::uint32_t INVALID = std::numeric_limits<std::uint32_t>::max();
+
+        // A stable reference to a view. A default Handle refers to nothing.
+        struct Handle
+        {
+            std::uint32_t index {INVALID};
+            std::uint32_t generation {0};
+
+            explicit operator bool() const;
+            bool operator==(const Handle& other) const;
+            bool operator!=(const Handle& other) const;
+        };
+
+        using iterator = std::vector<LSystemView>::iterator;
+        using const_iterator = std::vector<LSystemView>::const_iterator;
+
+        SceneRegistry() = default;
+
+        // Add 'view' to the registry and return its Handle.
+        Handle insert(LSystemView&& view);
+
+        // Erase the view of 'handle'.
+        // Exception:
+        //  - Precondition: 'handle' must refer to a view of the registry.
+        void erase(Handle handle);
+
+        // True if 'handle' refers to a view of the registry.
+        bool contains(Handle handle) const;
+
+        // The view of 'handle', nullptr if it was erased.
+        LSystemView* get(Handle handle);
+        const LSystemView* get(Handle handle) const;
+
+        // The Handle of the view at 'position' in the storage.
+        // Exception:
+        //  - Precondition: 'position' must be lesser than 'size()'.
+        Handle handle_at(std::size_t position) const;
+
+        // The views, in the order of iteration.
+        const std::vector<LSystemView>& views() const;
+
+        std::size_t size() const;
+        bool empty() const;
+
+        iterator begin();
+        iterator end();
+        const_iterator begin() const;
+        const_iterator end() const;
+
+    private:
+        // If the slot is used, 'position' is the position of its view in
+        // 'views_'. Otherwise, it is the index of the next free slot.
+        struct Slot
+        {
+            std::uint32_t position {INVALID};
+            std::uint32_t generation {0};
+        };
+
+        // The dense storage of the views, and the slot of each view.
+        std::vector<LSystemView> views_ {};
+        std::vector<std::uint32_t> slot_of_ {};
+
+        // The slots, and the head of the list of the free slots.
+        std::vector<Slot> slots_ {};
+        std::uint32_t free_slot_ {INVALID};
+    };
+}
+
+
+#endif // SCENE_REGISTRY_H
@@ -4,6 +4,10 @@
 
 #include <vector>
 #include <stack>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <optional>
 
 #include "LSystem.h"
 #include "DrawingParameters.h"
@@ -71,7 +75,9 @@ namespace drawing
 
             // All the iteration count produced by the LSystem. For each new
             // vertices, its iteration count will be copied to 'iteration_of_vertices'.
-            const std::vector<int> iteration_vec;
+            // Note: 'compute_vertices()' does not produce the LSystem, it
+            // sets the only element of this vector before each order.
+            std::vector<int> iteration_vec;
             
             // Index indicating the position in 'iteration_vec'.
             std::size_t iteration_index {0};
@@ -85,14 +91,92 @@ namespace drawing
     }
 
     // Compute all vertices and their iteration count of a turtle interpretation
-    // of a L-system.  First, this function iterates 'parameters.n_iter' times
-    // the LSystem 'lsys', using and modifying its cache. Then, it interprates
-    // the result with 'interpretation' and 'parameters'. The third returned
-    // value is the maximum number of iteration count.
+    // of a L-system. The result of 'parameters.n_iter' iterations of the
+    // LSystem 'lsys' is interpreted with 'interpretation' and 'parameters'.
+    // The third returned value is the maximum number of iteration count.
+    //
+    // The LSystem is not produced: its rules are expanded depth-first from
+    // the axiom. The expansion of a symbol for a number of remaining
+    // iterations always draws the same vertices, up to the rigid transform
+    // of the state of the turtle at its start (if it loads as many positions
+    // as it saves). These vertices are interpreted once, then copied and
+    // transformed at each other occurrence: the cost is in the number of
+    // vertices, not in the number of symbols of the production.
+    //
+    // If 'cancelled' is set to true (for example by another thread) during the
+    // computation, returns early with incomplete vertices.
+    // If 'partial' is set, it is regularly called during the interpretation
+    // with the vertices and iteration counts computed so far and the maximum
+    // number of iteration count, to display a partial result.
+    using partial_fn = std::function<void(const std::vector<sf::Vertex>&,
+                                          const std::vector<int>&,
+                                          int)>;
     std::tuple<std::vector<sf::Vertex>, std::vector<int>, int>
-        compute_vertices(LSystem& lsys,
-                         InterpretationMap& interpretation,
-                         const DrawingParameters& parameters);
+        compute_vertices(const LSystem& lsys,
+                         const InterpretationMap& interpretation,
+                         const DrawingParameters& parameters,
+                         const std::atomic<bool>* cancelled = nullptr,
+                         const partial_fn& partial = nullptr);
+
+    // Compute the vertices as 'compute_vertices()', but stop expanding a
+    // symbol once the whole drawing of its expansion fits in a disk of radius
+    // 'min_extent' (in the coordinates of the vertices): it is replaced by a
+    // single segment from the starting position to the ending position of
+    // the expansion. Such a symbol is too small to be distinguished on
+    // screen, so the drawing looks like the drawing of 'parameters.n_iter'
+    // iterations with a fraction of the vertices.
+    //
+    // The extent of each symbol is computed once for each remaining number
+    // of iterations from the extents of its successor. A symbol saving more
+    // positions than it loads (or the opposite) is never replaced.
+    //
+    // If 'region' is set, the symbols whose drawing does not intersect it are
+    // not expanded either: the turtle jumps directly to their ending
+    // position, and the jump is hidden as the loading of a position. Only the
+    // visible part of the drawing is computed, at a cost proportional to its
+    // size.
+    //
+    // If 'min_extent' is 0 and 'region' is not set, the result is the result
+    // of 'compute_vertices()'. 'cancelled' and 'partial' are used as in
+    // 'compute_vertices()'.
+    std::tuple<std::vector<sf::Vertex>, std::vector<int>, int>
+        compute_vertices_adaptive(const LSystem& lsys,
+                                  const InterpretationMap& interpretation,
+                                  const DrawingParameters& parameters,
+                                  double min_extent,
+                                  const std::optional<sf::FloatRect>& region = std::nullopt,
+                                  const std::atomic<bool>* cancelled = nullptr,
+                                  const partial_fn& partial = nullptr);
+
+    // The statistics of the drawing of 'compute_vertices()'.
+    struct Statistics
+    {
+        // The number of segments drawn and their total length.
+        std::uint64_t segments {0};
+        double length {0};
+        // The number of vertices: two for each segment and for each loaded
+        // position.
+        std::uint64_t vertices {0};
+        // The maximum number of positions saved at the same time.
+        std::uint64_t max_depth {0};
+        // The bounding box of the vertices, as computed by
+        // 'geometry::bounding_box()'.
+        sf::FloatRect bounding_box {};
+    };
+
+    // Predict the statistics of the drawing of 'compute_vertices()' without
+    // computing its vertices. The counts are computed from the memoized
+    // expansions of the symbols (see 'compute_vertices()') in O(number of
+    // (symbol, iteration) pairs) in general. If 'with_bounding_box' is set,
+    // the bounding box is computed by simulating the expansions which can
+    // enlarge it, which is generally a small part of the drawing.
+    // If 'cancelled' is set to true during the computation, returns early
+    // with incomplete statistics.
+    Statistics compute_statistics(const LSystem& lsys,
+                                  const InterpretationMap& interpretation,
+                                  const DrawingParameters& parameters,
+                                  bool with_bounding_box = true,
+                                  const std::atomic<bool>* cancelled = nullptr);
 }
 
 
@@ -2,7 +2,6 @@
 #define UNIQUE_ID_H
 
 
-#include <tuple>
 #include <vector>
 
 // Generate unique identifiers and recycle them.
@@ -15,6 +14,9 @@
 // Invariant:
 //   - Each new identifier is unique.
 //   - No new identifier are generated as long as freed old ones exists.
+//
+// The freed identifiers are kept in a stack: 'get_id()' and 'free_id()' are
+// O(1). The most recently freed identifier is reused first.
 class UniqueId
 {
 public:
@@ -25,22 +27,15 @@ public:
     // Free 'id': a call to 'get_id()' could returns this new id.
     //
     // Exceptions;
-    //   - Precondition: 'id' must exists in 'map_'
+    //   - Precondition: 'id' must be a used identifier.
     void free_id(int id);
 
 private:
-    // All the existing identifiers. The first element of the tuple is the id,
-    // and the second element is a boolean indicating if this id is free.
-    std::vector<std::tuple<int, bool>> map_ {};
-    // Definitions to ease the use of std::get<> for the map_'s tuples.
-    enum TupleElement
-    {
-        Id = 0,
-        IsFree
-    };
+    // For each identifier ever generated, true if it is free.
+    std::vector<bool> is_free_ {};
 
-    // The next new identifier.
-    int next_id_ {0};
+    // The stack of the free identifiers.
+    std::vector<int> free_ids_ {};
 };
 
 #endif // UNIQUE_ID_HPP
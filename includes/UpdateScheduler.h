@@ -0,0 +1,96 @@
+#ifndef UPDATE_SCHEDULER_H
+#define UPDATE_SCHEDULER_H
+
+
+#include <array>
+#include <functional>
+
+// Coalesce the notifications of several 'Observable' into a single update per
+// frame.
+//
+// Every time an observed model is modified, 'notify()' calls synchronously all
+// the callbacks. When a single user interaction modifies several models (or
+// the same one several times) in the same frame, an observer recomputing its
+// state in its callbacks would do it several times for nothing.
+// Instead, the callbacks simply 'mark()' a stage as dirty and the observer
+// calls 'flush()' once per frame, before using its state.
+//
+// The stages are ordered by their dependencies: derive -> interpret ->
+// transform -> paint.
+// Invalidating a stage invalidates all the following ones, so 'flush()'
+// executes the tasks starting from the earliest dirty stage, each one exactly
+// once.
+//
+// The tasks usually capture 'this' of the owner: they must be re-set with
+// 'set_task()' each time the owner is copied or moved, in the same way as the
+// 'Observer<>' callbacks.
+class UpdateScheduler
+{
+public:
+    // The stages in their dependency order.
+    enum Stage
+    {
+        Derive = 0,
+        Interpret,
+        Transform,
+        Paint,
+        StageCount
+    };
+
+    // The statistics of the scheduler. The difference between 'notifications'
+    // and 'executions' is the number of recomputations avoided.
+    struct Counters
+    {
+        // Number of 'mark()' calls for each stage.
+        std::array<unsigned long, StageCount> notifications {};
+        // Number of tasks executed for each stage.
+        std::array<unsigned long, StageCount> executions {};
+        // Number of 'flush()' calls that executed at least one task.
+        unsigned long flushes {0};
+
+        // Number of executions avoided by coalescing the notifications of
+        // 'stage'.
+        unsigned long coalesced(Stage stage) const;
+        // Total number of executions avoided.
+        unsigned long coalesced() const;
+    };
+
+    UpdateScheduler() = default;
+
+    // Set the task executed when 'stage' is flushed. A nullptr task is a valid
+    // no-op task: its stage is still used to order the dependencies.
+    void set_task(Stage stage, const std::function<void()>& task);
+
+    // Mark 'stage' as dirty. Nothing is computed until 'flush()'.
+    void mark(Stage stage);
+
+    // True if at least one stage is dirty.
+    bool is_dirty() const;
+
+    // Execute the tasks from the earliest dirty stage to the last one, in
+    // order, and clean all the stages.
+    // The stages are cleaned before executing the tasks, so a task marking a
+    // stage (for example with a nested 'notify()') will be executed at the next
+    // 'flush()'.
+    void flush();
+
+    // Clean all the stages without executing anything. Used when the state of
+    // the owner is already up-to-date.
+    void clear();
+
+    // Getter
+    const Counters& get_counters() const;
+
+private:
+    // The tasks of each stage.
+    std::array<std::function<void()>, StageCount> tasks_ {};
+
+    // The earliest dirty stage. 'StageCount' if every stage is clean.
+    int first_dirty_ {StageCount};
+
+    // The statistics.
+    Counters counters_ {};
+};
+
+
+#endif // UPDATE_SCHEDULER_H
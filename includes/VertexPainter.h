@@ -4,6 +4,7 @@
 
 #include <memory>
 #include <SFML/Graphics.hpp>
+#include <gsl/gsl>
 #include "Observable.h"
 #include "Observer.h"
 #include "ColorsGenerator.h"
@@ -45,7 +46,7 @@ namespace colors
         // 'iteration_of_vertices' according to a rule with the colors from
         // 'ColorGeneratorWrapper::ColorGenerator'.
         virtual void paint_vertices(std::vector<sf::Vertex>& vertices,
-                                    const std::vector<int>& iteration_of_vertices,
+                                    gsl::span<const int> iteration_of_vertices,
                                     int max_recursion,
                                     sf::FloatRect bounding_box) = 0;
 
@@ -104,7 +104,7 @@ namespace colors
         void set_child_painters(const std::list<std::shared_ptr<VertexPainterWrapper>> painters);
        
         virtual void paint_vertices(std::vector<sf::Vertex>& vertices,
-                                    const std::vector<int>& iteration_of_vertices,
+                                    gsl::span<const int> iteration_of_vertices,
                                     int max_recursion,
                                     sf::FloatRect bounding_box) override;
 
@@ -21,7 +21,7 @@ namespace colors
         // current iteration by the max iteration.
         // 'bounding_box' is not used.
         virtual void paint_vertices(std::vector<sf::Vertex>& vertices,
-                                    const std::vector<int>& vertices_iteration,
+                                    gsl::span<const int> vertices_iteration,
                                     int max_iteration,
                                     sf::FloatRect bounding_box) override;
 
@@ -30,7 +30,7 @@ namespace colors
         // according to the rule with the colors from the ColorGenerator.
         // 'iteration_of_vertices' and 'max_recursion' are not used.
         virtual void paint_vertices(std::vector<sf::Vertex>& vertices,
-                                    const std::vector<int>& iteration_of_vertices,
+                                    gsl::span<const int> iteration_of_vertices,
                                     int max_recursion,
                                     sf::FloatRect bounding_box) override;
 
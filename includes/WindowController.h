@@ -2,13 +2,16 @@
 #define WINDOW_CONTROLLER_H
 
 
-#include <list>
+#include <array>
+#include <memory>
 #include <experimental/filesystem>
 
 #include <SFML/Graphics.hpp>
 
 #include "imgui/imgui.h"
+#include "DirectoryIndex.h"
 #include "LSystemView.h"
+#include "SceneRegistry.h"
 
 namespace controller
 {
@@ -28,7 +31,7 @@ namespace controller
         // of the 'window'.
         static void handle_input(std::vector<sf::Event> events,
                                  sf::RenderWindow& window,
-                                 std::list<procgui::LSystemView>& lsys_views);
+                                 procgui::SceneRegistry& lsys_views);
 
         // The 'sf::Mouse::getPosition()' give the absolute position in a
         // window. This method get the mouse position with the application
@@ -50,27 +53,34 @@ namespace controller
         static bool save_menu_open_;
 
     private:
+        // Helper method to move 'view' so that the middle of its bounding box
+        // is at 'position'.
+        static void place_view(procgui::LSystemView& view, const sf::Vector2f& position);
+
         // Helper method to paste 'view' at 'position' and add it to
         // 'lsys_views'. 
-        static void paste_view(std::list<procgui::LSystemView>& lsys_views,
+        static void paste_view(procgui::SceneRegistry& lsys_views,
                                const std::optional<procgui::LSystemView>& view,
-                               const sf::Vector2f& position,
-                               bool is_loaded_from_disk = false);
+                               const sf::Vector2f& position);
 
         // The right-click menu managing everything between
         // creation/copy-pasting of LSystemViews, saving and loading.
-        static void right_click_menu(sf::RenderWindow& window, std::list<procgui::LSystemView>& lsys_view);
+        static void right_click_menu(sf::RenderWindow& window, procgui::SceneRegistry& lsys_view);
+
+        // Private flag to save all of 'lsys_views' as a scene in the save
+        // menu instead of the LSystemView under the mouse.
+        static bool save_scene_;
 
         // Display and interact with the save menu window.
         // Managed the window, opening and saving into a file.
-        static void save_menu();
+        static void save_menu(const procgui::SceneRegistry& lsys_views);
 
         // Private flag to let the load menu open between frames.
         static bool load_menu_open_;
 
         // Display and interact with the load menu window. Load from files the
         // LSystems into 'lsys_views'.
-        static void load_menu(std::list<procgui::LSystemView>& lsys_views);
+        static void load_menu(procgui::SceneRegistry& lsys_views);
 
         // When ordering the load menu to open, save the current mouse position
         // to load the LSystemView at this position instead of the center.
@@ -97,6 +107,19 @@ namespace controller
         
         // The fixed save directory of the application
         static std::experimental::filesystem::path save_dir_;
+
+        // The index of 'save_dir_', created at the first opening of the save
+        // or load menu.
+        static std::unique_ptr<DirectoryIndex> save_index_;
+
+        // Display the files of 'save_dir_' in a filtered and clipped list and
+        // set 'filename' to the file clicked. Returns false if 'save_dir_'
+        // can not be read.
+        static bool save_files_list(std::array<char, FILENAME_LENGTH_>& filename);
+
+        // The file of the exported performance trace (Chrome trace event
+        // format).
+        static std::experimental::filesystem::path trace_file_;
     };
 }
 
@@ -0,0 +1,82 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Simple fixed-size pool of worker threads.
+//
+// Tasks are submitted with 'submit()' and executed in FIFO order by the first
+// available thread. The result (or the exception) of a task is accessible with
+// the returned 'std::future'. Contrary to the futures returned by
+// 'std::async()', these futures do not block at destruction: a task whose
+// result is no longer needed can simply be forgotten (and cancelled
+// cooperatively by the task itself).
+//
+// 'shutdown()' (called by the destructor) discards the queued tasks and waits
+// for the running ones: the futures of the discarded tasks are broken (their
+// 'get()' throws a 'std::future_error'). A pool whose tasks use other static
+// objects must be shut down before the end of 'main()': the tasks would
+// otherwise run during the destruction of the static objects.
+class WorkerPool
+{
+public:
+    // Create a pool of 'n_threads' threads.
+    // Exception:
+    //  - Precondition: 'n_threads' must be strictly positive.
+    explicit WorkerPool(unsigned n_threads = default_thread_count());
+    ~WorkerPool();
+
+    // A pool is neither copyable nor movable: the threads refer to it.
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool(WorkerPool&&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    WorkerPool& operator=(WorkerPool&&) = delete;
+
+    // Add the callable 'f' to the queue of tasks. After 'shutdown()', 'f' is
+    // discarded.
+    template<typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& f);
+
+    // Discard the queued tasks and wait for the running ones to finish. The
+    // pool does not execute any task afterwards.
+    // Must not be called by a task of the pool.
+    void shutdown();
+
+    // The number of threads in the pool.
+    std::size_t size() const;
+
+    // All the hardware threads but one (reserved for the GUI), with at least
+    // one thread.
+    static unsigned default_thread_count();
+
+    // True if the current thread is a thread of a WorkerPool. A task must not
+    // wait for other tasks of the pools: they may be queued behind it.
+    static bool is_worker_thread();
+
+private:
+    // The loop of each thread: wait for a task and execute it until 'stop_'.
+    void work();
+
+    std::vector<std::thread> threads_;
+
+    // The queue of tasks and its synchronization primitives.
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+
+    // Set by 'shutdown()' to stop the threads.
+    bool stop_ {false};
+};
+
+#include "WorkerPool.tpp"
+
+
+#endif // WORKER_POOL_H
@@ -0,0 +1,21 @@
+template<typename F>
+std::future<std::invoke_result_t<F>> WorkerPool::submit(F&& f)
+{
+    using result = std::invoke_result_t<F>;
+
+    // 'std::function' must be copyable, but 'std::packaged_task' is not: it
+    // is shared instead.
+    auto task = std::make_shared<std::packaged_task<result()>>(std::forward<F>(f));
+    auto future = task->get_future();
+    {
+        // Once the pool is shut down, 'task' is destroyed unexecuted: its
+        // future is broken.
+        std::lock_guard<std::mutex> lock (mutex_);
+        if (!stop_)
+        {
+            tasks_.emplace_back([task](){(*task)();});
+        }
+    }
+    condition_.notify_one();
+    return future;
+}
@@ -34,7 +34,10 @@ namespace geometry
     sf::Vector2f project_and_clamp(sf::Vector2f A, sf::Vector2f B, sf::Vector2f p);
 
     // Compute the bounding box of a set of vertices.
-    // Complexity in time is in O(n), n being the number of vertices.
+    // Complexity in time is in O(n), n being the number of vertices. The
+    // computation is vectorized (SSE, if available) and split between
+    // threads for large sets of vertices, except in the threads of a
+    // WorkerPool.
     sf::FloatRect bounding_box(const std::vector<sf::Vertex>& vertices);
 
     // Divide the vertices into 'max_boxes_'-1 equal part (with a remainder) and
@@ -42,7 +45,9 @@ namespace geometry
     // fitting "hitbox" of a set of vertices. The hitboxes overlap by one
     // vertex to not have any edge left out.
     // 
-    // Complexity in time is in O(n), n being the number of vertices.
+    // Complexity in time is in O(n), n being the number of vertices. The
+    // boxes are computed like 'bounding_box()', without copy, and in parallel
+    // for large sets of vertices.
     //
     // Note: The algorithm breaks for low count of vertices: it returns a
     // correct set of bounding boxes but 'max_boxes' is not respected. See the
@@ -50,6 +55,51 @@ namespace geometry
     std::vector<sf::FloatRect> sub_boxes(const std::vector<sf::Vertex>& vertices,
                                                  int max_boxes);
 
+    // Divide the vertices into chunks of 'chunk_size' vertices and compute the
+    // bounding box of each chunk. Each chunk also contains the first vertex of
+    // the next one so that no edge of a line strip is left out. It is used to
+    // draw only the parts of a set of vertices inside the viewport.
+    //
+    // Complexity in time is in O(n), n being the number of vertices.
+    //
+    // Exception:
+    //   - Precondition: 'chunk_size' must be strictly positive.
+    std::vector<sf::FloatRect> chunk_boxes(const std::vector<sf::Vertex>& vertices,
+                                           std::size_t chunk_size);
+
+    // Computes the ranges of vertices (first vertex, number of vertices) of
+    // the chunks overlapping 'area'. 'boxes' must have been computed with
+    // 'chunk_boxes()' on 'n_vertices' vertices and 'chunk_size'. Consecutive
+    // chunks are merged into a single range.
+    //
+    // Complexity in time is in O(n), n being the number of chunks.
+    std::vector<std::pair<std::size_t, std::size_t>> visible_ranges(const std::vector<sf::FloatRect>& boxes,
+                                                                    std::size_t chunk_size,
+                                                                    std::size_t n_vertices,
+                                                                    const sf::FloatRect& area);
+
+    // Simplify the line strip 'vertices': a vertex is removed if it is at a
+    // distance less than 'tolerance' from the last vertex kept, so the
+    // simplified line strip deviates at most by 'tolerance' from the
+    // original. The first and last vertices, and the vertices at the border
+    // of a color run (including the transparent vertices of the moves without
+    // drawing) are always kept.
+    //
+    // A color run is a sequence of vertices whose channels differ by at most
+    // 'color_tolerance' from one vertex to the next: the gradients of the
+    // painters are simplified, their colors being interpolated along the
+    // kept segments, but not the sharp color changes.
+    //
+    // Complexity in time is in O(n), n being the number of vertices.
+    std::vector<sf::Vertex> simplify(const std::vector<sf::Vertex>& vertices,
+                                     float tolerance,
+                                     int color_tolerance = 0);
+
+    // Check if 'a' and 'b' overlap. Contrary to 'sf::Rect::intersects()',
+    // boxes with a null width or height (like the bounding box of a straight
+    // line) and boxes touching each other are considered overlapping.
+    bool overlap(const sf::FloatRect& a, const sf::FloatRect& b);
+
     // Expand 'boxes' by 'expension' in all directions.
     void expand_boxes(std::vector<sf::FloatRect>& boxes, float expension=5.f);
 
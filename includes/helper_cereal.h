@@ -0,0 +1,91 @@
+#ifndef HELPER_CEREAL_H
+#define HELPER_CEREAL_H
+
+
+#include <cstdint>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "cereal/cereal.hpp"
+#include "cereal/types/vector.hpp"
+
+// Compact serialization of arrays of SFML types for binary archives.
+//
+// Each field is gathered in a contiguous array saved as a single block with
+// 'cereal::binary_data()': saving and loading millions of vertices are bulk
+// copies instead of millions of calls to the archive, and the portable binary
+// archives can still swap the endianness of each value.
+namespace ext::sf
+{
+    // Save the positions and colors of 'vertices'. The texture coordinates
+    // are not saved: the drawings are not textured.
+    template<class Archive>
+    void save_vertices(Archive& ar, const std::vector<::sf::Vertex>& vertices)
+    {
+        std::vector<float> positions (2 * vertices.size());
+        std::vector<std::uint8_t> colors (4 * vertices.size());
+        for (std::size_t i = 0; i < vertices.size(); ++i)
+        {
+            const auto& v = vertices[i];
+            positions[2*i] = v.position.x;
+            positions[2*i+1] = v.position.y;
+            colors[4*i] = v.color.r;
+            colors[4*i+1] = v.color.g;
+            colors[4*i+2] = v.color.b;
+            colors[4*i+3] = v.color.a;
+        }
+        ar(positions, colors);
+    }
+
+    template<class Archive>
+    void load_vertices(Archive& ar, std::vector<::sf::Vertex>& vertices)
+    {
+        std::vector<float> positions;
+        std::vector<std::uint8_t> colors;
+        ar(positions, colors);
+        if (colors.size() != 2 * positions.size())
+        {
+            throw ::cereal::Exception("Inconsistent size of the vertices");
+        }
+
+        vertices.resize(positions.size() / 2);
+        for (std::size_t i = 0; i < vertices.size(); ++i)
+        {
+            vertices[i].position = {positions[2*i], positions[2*i+1]};
+            vertices[i].color = {colors[4*i], colors[4*i+1], colors[4*i+2], colors[4*i+3]};
+        }
+    }
+
+    template<class Archive>
+    void save_rects(Archive& ar, const std::vector<::sf::FloatRect>& rects)
+    {
+        std::vector<float> values (4 * rects.size());
+        for (std::size_t i = 0; i < rects.size(); ++i)
+        {
+            values[4*i] = rects[i].left;
+            values[4*i+1] = rects[i].top;
+            values[4*i+2] = rects[i].width;
+            values[4*i+3] = rects[i].height;
+        }
+        ar(values);
+    }
+
+    template<class Archive>
+    void load_rects(Archive& ar, std::vector<::sf::FloatRect>& rects)
+    {
+        std::vector<float> values;
+        ar(values);
+        if (values.size() % 4 != 0)
+        {
+            throw ::cereal::Exception("Inconsistent size of the rectangles");
+        }
+
+        rects.resize(values.size() / 4);
+        for (std::size_t i = 0; i < rects.size(); ++i)
+        {
+            rects[i] = {values[4*i], values[4*i+1], values[4*i+2], values[4*i+3]};
+        }
+    }
+}
+
+
+#endif // HELPER_CEREAL_H
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <cmath>
+#include "BoxTree.h"
+#include "geometry.h"
+
+namespace geometry
+{
+    BoxTree::BoxTree(const std::vector<sf::FloatRect>& boxes)
+        : nodes_ {}
+        , items_ (boxes.size())
+        , boxes_ {boxes}
+    {
+        if (boxes.empty())
+        {
+            return;
+        }
+
+        for (std::uint32_t i = 0; i < items_.size(); ++i)
+        {
+            items_[i] = i;
+        }
+        // A binary tree with leaves of at least LEAF_SIZE/2 items.
+        nodes_.reserve(4 * boxes.size() / LEAF_SIZE + 1);
+        build(0, items_.size());
+    }
+
+    std::size_t BoxTree::size() const
+    {
+        return items_.size();
+    }
+
+    std::uint32_t BoxTree::build(std::uint32_t first, std::uint32_t last)
+    {
+        // Bounding box of the items.
+        const auto& first_box = boxes_[items_[first]];
+        float left = first_box.left, right = first_box.left + first_box.width;
+        float top = first_box.top, down = first_box.top + first_box.height;
+        for (auto i = first + 1; i < last; ++i)
+        {
+            const auto& box = boxes_[items_[i]];
+            left = std::min(left, box.left);
+            right = std::max(right, box.left + box.width);
+            top = std::min(top, box.top);
+            down = std::max(down, box.top + box.height);
+        }
+
+        std::uint32_t index = nodes_.size();
+        nodes_.push_back({{left, top, right - left, down - top}, first, last - first, 0});
+        if (last - first <= LEAF_SIZE)
+        {
+            return index;
+        }
+
+        // Split the items at the median of their center along the longest
+        // axis of the node.
+        bool horizontal = right - left >= down - top;
+        auto middle = first + (last - first) / 2;
+        std::nth_element(begin(items_) + first, begin(items_) + middle, begin(items_) + last,
+                         [this, horizontal](auto a, auto b)
+                         {
+                             const auto& box_a = boxes_[a];
+                             const auto& box_b = boxes_[b];
+                             return horizontal ?
+                                 box_a.left + box_a.width / 2 < box_b.left + box_b.width / 2 :
+                                 box_a.top + box_a.height / 2 < box_b.top + box_b.height / 2;
+                         });
+
+        // The first child is always the next node.
+        build(first, middle);
+        auto second = build(middle, last);
+        nodes_[index].count = 0;
+        nodes_[index].second = second;
+        return index;
+    }
+
+    float BoxTree::distance_to_box(const sf::Vector2f& point, const sf::FloatRect& box)
+    {
+        float dx = std::max({box.left - point.x, 0.f, point.x - (box.left + box.width)});
+        float dy = std::max({box.top - point.y, 0.f, point.y - (box.top + box.height)});
+        return std::sqrt(dx*dx + dy*dy);
+    }
+}
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cctype>
+#include <tuple>
+#include "DirectoryIndex.h"
+
+namespace fs = std::experimental::filesystem;
+
+bool DirectoryIndex::File::operator==(const File& other) const
+{
+    return filename == other.filename;
+}
+
+DirectoryIndex::DirectoryIndex(const fs::path& directory, std::chrono::milliseconds period)
+    : directory_ {directory}
+    , period_ {period}
+    , last_write_time_ {}
+    , mutex_ {}
+    , condition_ {}
+    , files_ {std::make_shared<const Files>()}
+    , thread_ {}
+{
+    // The first reading is synchronous: the list is immediately available.
+    std::error_code error;
+    last_write_time_ = fs::last_write_time(directory_, error);
+    scan();
+    thread_ = std::thread([this](){poll();});
+}
+
+DirectoryIndex::~DirectoryIndex()
+{
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        stop_ = true;
+    }
+    condition_.notify_one();
+    thread_.join();
+}
+
+std::shared_ptr<const DirectoryIndex::Files> DirectoryIndex::get_files() const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return files_;
+}
+
+bool DirectoryIndex::is_valid() const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return is_valid_;
+}
+
+unsigned long DirectoryIndex::get_generation() const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return generation_;
+}
+
+void DirectoryIndex::refresh()
+{
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        refresh_requested_ = true;
+    }
+    condition_.notify_one();
+}
+
+std::vector<std::size_t> DirectoryIndex::filter(const Files& files, const std::string& pattern)
+{
+    auto key = sort_key(pattern);
+    std::vector<std::size_t> indices;
+    for (std::size_t i = 0; i < files.size(); ++i)
+    {
+        if (files[i].sort_key.find(key) != std::string::npos)
+        {
+            indices.push_back(i);
+        }
+    }
+    return indices;
+}
+
+std::string DirectoryIndex::sort_key(const std::string& filename)
+{
+    std::string key = filename;
+    std::transform(begin(key), end(key), begin(key),
+                   [](unsigned char c){return std::tolower(c);});
+    return key;
+}
+
+void DirectoryIndex::poll()
+{
+    std::unique_lock<std::mutex> lock (mutex_);
+    while (!stop_)
+    {
+        condition_.wait_for(lock, period_, [this](){return stop_ || refresh_requested_;});
+        if (stop_)
+        {
+            break;
+        }
+        bool forced = refresh_requested_;
+        refresh_requested_ = false;
+
+        // The file system is accessed without the lock: the GUI is never
+        // blocked.
+        lock.unlock();
+        std::error_code error;
+        auto write_time = fs::last_write_time(directory_, error);
+        if (forced || error || write_time != last_write_time_)
+        {
+            last_write_time_ = write_time;
+            scan();
+        }
+        lock.lock();
+    }
+}
+
+void DirectoryIndex::scan()
+{
+    Files files;
+    bool valid = true;
+    try
+    {
+        for (const auto& file : fs::directory_iterator(directory_))
+        {
+            if (fs::is_regular_file(file.status()))
+            {
+                auto filename = file.path().filename().string();
+                auto key = sort_key(filename);
+                files.push_back({std::move(filename), std::move(key)});
+            }
+        }
+    }
+    catch (const fs::filesystem_error&)
+    {
+        valid = false;
+        files.clear();
+    }
+    std::sort(begin(files), end(files),
+              [](const auto& left, const auto& right)
+              {
+                  return std::tie(left.sort_key, left.filename) < std::tie(right.sort_key, right.filename);
+              });
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (valid != is_valid_ || files != *files_)
+    {
+        files_ = std::make_shared<const Files>(std::move(files));
+        is_valid_ = valid;
+        ++generation_;
+    }
+}
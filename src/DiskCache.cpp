@@ -0,0 +1,445 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "DiskCache.h"
+
+namespace fs = std::experimental::filesystem;
+
+namespace
+{
+    // The layout of an entry:
+    //   - MAGIC
+    //   - the key (8 bytes)
+    //   - the number of blocks (8 bytes)
+    //   - the size of each block (8 bytes each)
+    //   - the blocks, each one starting at a multiple of ALIGNMENT. The first
+    //     block is the identity of the entry.
+    // The last character of MAGIC is the version of the format: incrementing
+    // it invalidates all the entries.
+    constexpr char MAGIC[8] = {'P', 'G', 'C', 'A', 'C', 'H', 'E', '2'};
+    constexpr std::size_t ALIGNMENT = 64;
+    constexpr const char* EXTENSION = ".entry";
+
+    std::size_t align(std::size_t offset)
+    {
+        return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    // The canonical bytes of a state, in the native representation of the
+    // machine.
+    class Identity
+    {
+    public:
+        void add(const void* data, std::size_t size)
+            {
+                bytes_.append(static_cast<const char*>(data), size);
+            }
+
+        template<typename T>
+        void add(T value)
+            {
+                static_assert(std::is_arithmetic_v<T>);
+                add(&value, sizeof(T));
+            }
+
+        // The size is added first: "ab"+"c" and "a"+"bc" are different.
+        void add(const std::string& str)
+            {
+                add(str.size());
+                add(str.data(), str.size());
+            }
+
+        const std::string& bytes() const
+            {
+                return bytes_;
+            }
+
+    private:
+        std::string bytes_ {};
+    };
+
+    // The state of 'lsys' without the caches. The rules are added in order.
+    void add_lsystem(Identity& identity, const LSystem& lsys)
+    {
+        identity.add(lsys.get_axiom());
+        std::map<char, std::string> rules (begin(lsys.get_rules()), end(lsys.get_rules()));
+        identity.add(rules.size());
+        for (const auto& [predecessor, successor] : rules)
+        {
+            identity.add(predecessor);
+            identity.add(successor);
+        }
+        identity.add(lsys.get_iteration_predecessors());
+    }
+}
+
+std::mutex DiskCache::mutex_ {};
+fs::path DiskCache::directory_ {};
+std::uintmax_t DiskCache::max_bytes_ {DEFAULT_MAX_BYTES};
+std::size_t DiskCache::min_entry_bytes_ {DEFAULT_MIN_ENTRY_BYTES};
+
+DiskCache::Entry::Entry(const fs::path& path, std::uint64_t key, const std::string& identity)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("DiskCache: can not open " + path.string());
+    }
+    struct stat status;
+    if (::fstat(fd, &status) < 0 || status.st_size == 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("DiskCache: invalid entry " + path.string());
+    }
+    size_ = status.st_size;
+    void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after closing the file.
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        size_ = 0;
+        throw std::runtime_error("DiskCache: can not map " + path.string());
+    }
+    data_ = static_cast<const char*>(data);
+
+    // Check the header and the blocks' sizes.
+    auto read_u64 = [this](std::size_t offset)
+        {
+            std::uint64_t value;
+            std::memcpy(&value, data_ + offset, sizeof(value));
+            return value;
+        };
+    std::size_t offset = sizeof(MAGIC) + 2 * sizeof(std::uint64_t);
+    bool valid = size_ >= offset &&
+                 std::memcmp(data_, MAGIC, sizeof(MAGIC)) == 0 &&
+                 read_u64(sizeof(MAGIC)) == key;
+    std::uint64_t n_blocks = valid ? read_u64(sizeof(MAGIC) + sizeof(std::uint64_t)) : 0;
+    valid = valid && n_blocks <= (size_ - offset) / sizeof(std::uint64_t);
+    if (valid)
+    {
+        std::size_t block_offset = align(offset + n_blocks * sizeof(std::uint64_t));
+        for (std::uint64_t i = 0; valid && i < n_blocks; ++i)
+        {
+            std::uint64_t size = read_u64(offset + i * sizeof(std::uint64_t));
+            valid = block_offset <= size_ && size <= size_ - block_offset;
+            blocks_.push_back({block_offset, size});
+            block_offset = align(block_offset + size);
+        }
+    }
+    // Different models with the same key.
+    valid = valid && !blocks_.empty() && blocks_.front().second == identity.size() &&
+            std::memcmp(data_ + blocks_.front().first, identity.data(), identity.size()) == 0;
+    if (!valid)
+    {
+        unmap();
+        throw std::runtime_error("DiskCache: invalid entry " + path.string());
+    }
+    blocks_.erase(begin(blocks_));
+}
+
+DiskCache::Entry::~Entry()
+{
+    unmap();
+}
+
+DiskCache::Entry::Entry(Entry&& other)
+    : data_ {other.data_}
+    , size_ {other.size_}
+    , blocks_ {std::move(other.blocks_)}
+{
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+DiskCache::Entry& DiskCache::Entry::operator=(Entry&& other)
+{
+    if (this != &other)
+    {
+        unmap();
+        data_ = other.data_;
+        size_ = other.size_;
+        blocks_ = std::move(other.blocks_);
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+std::size_t DiskCache::Entry::n_blocks() const
+{
+    return blocks_.size();
+}
+
+void DiskCache::Entry::unmap()
+{
+    if (data_)
+    {
+        ::munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+void DiskCache::open(const fs::path& directory, std::uintmax_t max_bytes, std::size_t min_entry_bytes)
+{
+    Expects(!directory.empty());
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (error)
+    {
+        directory_.clear();
+        return;
+    }
+    directory_ = directory;
+    max_bytes_ = max_bytes;
+    min_entry_bytes_ = min_entry_bytes;
+    evict();
+}
+
+void DiskCache::close()
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    directory_.clear();
+}
+
+bool DiskCache::is_open()
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return !directory_.empty();
+}
+
+void DiskCache::clear()
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (directory_.empty())
+    {
+        return;
+    }
+    std::error_code error;
+    for (const auto& file : fs::directory_iterator(directory_, error))
+    {
+        if (file.path().extension() == EXTENSION)
+        {
+            fs::remove(file.path(), error);
+        }
+    }
+}
+
+std::optional<DiskCache::Entry> DiskCache::find(std::uint64_t key, const std::string& identity)
+{
+    fs::path path;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        if (directory_.empty())
+        {
+            return {};
+        }
+        path = entry_path(key);
+    }
+
+    std::error_code error;
+    if (!fs::exists(path, error))
+    {
+        return {};
+    }
+    try
+    {
+        Entry entry (path, key, identity);
+        // The modification time is the time of the last use for the
+        // eviction.
+        fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+        return entry;
+    }
+    catch (const std::runtime_error&)
+    {
+        // Corrupted, evicted in the meantime, or the entry of other models.
+        return {};
+    }
+}
+
+void DiskCache::store(std::uint64_t key, const std::string& identity,
+                      const std::vector<Block>& user_blocks)
+{
+    fs::path path;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        std::size_t total = 0;
+        for (const auto& block : user_blocks)
+        {
+            total += block.size();
+        }
+        if (directory_.empty() || total < min_entry_bytes_)
+        {
+            return;
+        }
+        path = entry_path(key);
+    }
+    // The identity is the first block.
+    std::vector<Block> blocks {gsl::as_bytes(gsl::make_span(identity.data(), identity.size()))};
+    blocks.insert(end(blocks), begin(user_blocks), end(user_blocks));
+
+    // Write in a temporary file unique to the thread, then rename it.
+    std::ostringstream suffix;
+    suffix << ".tmp" << std::hash<std::thread::id>()(std::this_thread::get_id());
+    fs::path tmp_path = path;
+    tmp_path += suffix.str();
+    {
+        std::ofstream ofs (tmp_path, std::ios::binary);
+        std::uint64_t n_blocks = blocks.size();
+        ofs.write(MAGIC, sizeof(MAGIC));
+        ofs.write(reinterpret_cast<const char*>(&key), sizeof(key));
+        ofs.write(reinterpret_cast<const char*>(&n_blocks), sizeof(n_blocks));
+        for (const auto& block : blocks)
+        {
+            std::uint64_t size = block.size();
+            ofs.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        }
+
+        std::size_t offset = sizeof(MAGIC) + (2 + blocks.size()) * sizeof(std::uint64_t);
+        const char padding[ALIGNMENT] {};
+        for (const auto& block : blocks)
+        {
+            ofs.write(padding, align(offset) - offset);
+            offset = align(offset);
+            ofs.write(reinterpret_cast<const char*>(block.data()), block.size());
+            offset += block.size();
+        }
+        if (!ofs)
+        {
+            ofs.close();
+            std::error_code error;
+            fs::remove(tmp_path, error);
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    std::error_code error;
+    fs::rename(tmp_path, path, error);
+    if (error)
+    {
+        fs::remove(tmp_path, error);
+        return;
+    }
+    evict();
+}
+
+std::uint64_t DiskCache::key(const std::string& identity)
+{
+    // 64-bit FNV-1a hash.
+    std::uint64_t hash = 0xcbf29ce484222325;
+    for (unsigned char byte : identity)
+    {
+        hash = (hash ^ byte) * 0x100000001b3;
+    }
+    return hash;
+}
+
+std::string DiskCache::geometry_identity(const LSystem& lsys,
+                                         const drawing::InterpretationMap& map,
+                                         const drawing::DrawingParameters& params)
+{
+    Identity identity;
+    identity.add(std::string("geometry"));
+    identity.add(INTERPRETER_VERSION);
+    add_lsystem(identity, lsys);
+
+    std::map<char, int> orders;
+    for (const auto& [symbol, order] : map.get_rules())
+    {
+        orders.emplace(symbol, static_cast<int>(order.id));
+    }
+    identity.add(orders.size());
+    for (const auto& [symbol, id] : orders)
+    {
+        identity.add(symbol);
+        identity.add(id);
+    }
+
+    identity.add(params.get_starting_angle());
+    identity.add(params.get_delta_angle());
+    identity.add(params.get_step());
+    identity.add(params.get_n_iter());
+    return identity.bytes();
+}
+
+std::uint64_t DiskCache::geometry_key(const LSystem& lsys,
+                                      const drawing::InterpretationMap& map,
+                                      const drawing::DrawingParameters& params)
+{
+    return key(geometry_identity(lsys, map, params));
+}
+
+void DiskCache::evict()
+{
+    if (directory_.empty())
+    {
+        return;
+    }
+
+    struct File
+    {
+        fs::path path;
+        std::uintmax_t size;
+        fs::file_time_type last_use;
+    };
+    std::vector<File> files;
+    std::uintmax_t total = 0;
+    std::error_code error;
+    for (const auto& file : fs::directory_iterator(directory_, error))
+    {
+        if (file.path().extension() != EXTENSION)
+        {
+            continue;
+        }
+        auto size = fs::file_size(file.path(), error);
+        auto last_use = fs::last_write_time(file.path(), error);
+        if (!error)
+        {
+            files.push_back({file.path(), size, last_use});
+            total += size;
+        }
+    }
+    if (total <= max_bytes_)
+    {
+        return;
+    }
+
+    std::sort(begin(files), end(files),
+              [](const auto& left, const auto& right){return left.last_use < right.last_use;});
+    for (const auto& file : files)
+    {
+        if (total <= max_bytes_)
+        {
+            break;
+        }
+        // A mapped entry stays readable after its removal.
+        if (fs::remove(file.path, error))
+        {
+            total -= file.size;
+        }
+    }
+}
+
+fs::path DiskCache::entry_path(std::uint64_t key)
+{
+    std::ostringstream name;
+    name << std::hex;
+    name.width(16);
+    name.fill('0');
+    name << key << EXTENSION;
+    return directory_ / name.str();
+}
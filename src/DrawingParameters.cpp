@@ -40,32 +40,46 @@ namespace drawing
     {
         return n_iter_;
     }
+    DrawingParameters::Field DrawingParameters::get_last_modified() const
+    {
+        return last_modified_;
+    }
+
+    void DrawingParameters::modified(Field field)
+    {
+        // An other field was already modified in the transaction.
+        if (is_notification_deferred() && last_modified_ != field)
+        {
+            field = Several;
+        }
+        last_modified_ = field;
+        notify();
+    }
 
     void DrawingParameters::set_starting_position(const ext::sf::Vector2d starting_position)
     {
         starting_position_ = starting_position;
-        // The starting position is only used when rendering the LSystem, so it
-        // does not 'notify()' to avoid re-calculating for nothing.
+        modified(StartingPosition);
     }
     void DrawingParameters::set_starting_angle(double starting_angle)
     {
         starting_angle_ = starting_angle;
-        notify();
+        modified(StartingAngle);
     }
     void DrawingParameters::set_delta_angle(double delta_angle)
     {
         delta_angle_ = delta_angle;
-        notify();
+        modified(DeltaAngle);
     }
     void DrawingParameters::set_step(double step)
     {
         step_ = step;
-        notify();
+        modified(Step);
     }
     void DrawingParameters::set_n_iter(int n_iter)
     {
         n_iter_ = n_iter;
-        notify();
+        modified(NIter);
     }
 
 }
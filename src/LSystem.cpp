@@ -1,5 +1,6 @@
 #include "gsl/gsl"
 #include "LSystem.h"
+#include "Profiler.h"
 
 
 LSystem::LSystem(const std::string& axiom, const production_rules& prod, const std::string& preds)
@@ -41,29 +42,29 @@ const std::unordered_map<int, std::pair<std::vector<int>, int>>& LSystem::get_it
 
 void LSystem::set_axiom(const std::string& axiom)
 {
+    // The axiom is stored in the cache: it is always reset, even in a
+    // transaction.
     production_cache_ = { {0, axiom} };
     iteration_count_cache_ = { {0, {std::vector<int>(axiom.size(), 0), 0} } };
+    caches_outdated_ = false;
     notify();
 } 
 
 void LSystem::add_rule(char predecessor, const RuleMap::successor& successor)
 {
-    production_cache_ = { {0, get_axiom()} };
-    iteration_count_cache_ = { {0, {std::vector<int>(get_axiom().size(), 0), 0} } };
+    invalidate_caches();
     RuleMap::add_rule(predecessor, successor);    
 }
 
 void LSystem::remove_rule(char predecessor)
 {
-    production_cache_ = { {0, get_axiom()} };
-    iteration_count_cache_ = { {0, {std::vector<int>(get_axiom().size(), 0), 0} } };
+    invalidate_caches();
     RuleMap::remove_rule(predecessor);
 }
 
 void LSystem::clear_rules()
 {
-    production_cache_ = { {0, get_axiom()} };
-    iteration_count_cache_ = { {0, {{std::vector<int>(get_axiom().size(), 0)}, 0}}};
+    invalidate_caches();
     RuleMap::clear_rules();
 }                             
 
@@ -74,6 +75,33 @@ void LSystem::set_iteration_predecessors(const std::string& predecessors)
     notify();
 }
 
+void LSystem::invalidate_caches()
+{
+    if (in_transaction())
+    {
+        caches_outdated_ = true;
+    }
+    else
+    {
+        reset_caches();
+    }
+}
+
+void LSystem::reset_caches()
+{
+    production_cache_ = { {0, get_axiom()} };
+    iteration_count_cache_ = { {0, {std::vector<int>(get_axiom().size(), 0), 0} } };
+    caches_outdated_ = false;
+}
+
+void LSystem::on_commit()
+{
+    if (caches_outdated_)
+    {
+        reset_caches();
+    }
+}
+
 
 // Edge Cases:
 //   - If 'production_cache_' is empty so does not contains the axiom, simply
@@ -83,6 +111,12 @@ std::tuple<std::string, std::vector<int>, int> LSystem::produce(int n)
 {
     Expects(n >= 0);
 
+    // The rules were modified in a transaction not committed yet.
+    if (caches_outdated_)
+    {
+        reset_caches();
+    }
+
     if (production_cache_.count(0) == 0 || production_cache_.count(0) == 0)
     {
         // We do not have any axiom so nothing to produce.
@@ -98,6 +132,8 @@ std::tuple<std::string, std::vector<int>, int> LSystem::produce(int n)
                 iteration_count_cache_.at(n).second};
     }
 
+    Profiler::Scope scope ("LSystem::produce");
+
     // The caches saves all the iteration from the start. So we get
     // the highest-iteration result for each cache.
     auto highest_production = std::max_element(production_cache_.begin(),
@@ -200,7 +236,8 @@ std::tuple<std::string, std::vector<int>, int> LSystem::produce(int n)
     // 'drawing::compute_vertices()' function.
 
     Ensures(production_cache_.size() >= iteration_count_cache_.size());
-    
+
+    scope.set_items(production_cache_.at(n).size());
     return {production_cache_.at(n), iteration_count_cache_.at(n).first, iteration_count_cache_.at(n).second};
 }
 
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "LSystemController.h"
 #include "WindowController.h"
 #include "imgui/imgui.h"
@@ -5,7 +6,7 @@
 
 namespace controller
 {
-    procgui::LSystemView* LSystemController::under_mouse_ {nullptr};
+    procgui::SceneRegistry::Handle LSystemController::under_mouse_ {};
     
     std::optional<procgui::LSystemView> LSystemController::saved_view_ {};
 
@@ -15,19 +16,23 @@ namespace controller
     std::chrono::time_point<std::chrono::steady_clock> LSystemController::click_time_ {};
 
     bool LSystemController::is_clone_ = false;
+
+    geometry::BoxTree LSystemController::views_tree_ {};
+    std::vector<procgui::SceneRegistry::Handle> LSystemController::tree_views_ {};
+    unsigned long LSystemController::tree_generation_ {0};
     
     bool LSystemController::has_priority()
     {
-        return under_mouse_ != nullptr;
+        return static_cast<bool>(under_mouse_);
     }
 
     const std::optional<procgui::LSystemView>& LSystemController::saved_view()
     {
         return saved_view_;
     }
-    const procgui::LSystemView* LSystemController::under_mouse()
+    const procgui::LSystemView* LSystemController::under_mouse(const procgui::SceneRegistry& views)
     {
-        return under_mouse_;
+        return views.get(under_mouse_);
     }
     bool LSystemController::is_clone()
     {
@@ -35,7 +40,7 @@ namespace controller
     }
 
     
-    void LSystemController::handle_input(std::list<procgui::LSystemView>& views, const sf::Event& event)
+    void LSystemController::handle_input(procgui::SceneRegistry& views, const sf::Event& event)
     {
         ImGuiIO& imgui_io = ImGui::GetIO();
 
@@ -54,71 +59,82 @@ namespace controller
                 click_time_ = std::chrono::steady_clock::now();
             }
             
+            // Only the LSystemViews whose bounding box contains the click are
+            // tested, from the last inserted one: it is drawn on top of the
+            // others.
+            update_views_tree(views);
+            auto click = WindowController::real_mouse_position({event.mouseButton.x,
+                                                                event.mouseButton.y});
+            std::vector<std::size_t> candidates;
+            views_tree_.query({click.x, click.y, 0, 0},
+                              [&candidates](std::size_t i){candidates.push_back(i);});
+            std::sort(rbegin(candidates), rend(candidates));
+            
             // We want to have a specific behaviour : if a click is inside the
             // hitboxes of a LSystemView, we select it for 'under_mouse_' UNLESS
             // an other view is already selected at this click.
-            auto to_select = views.end();
+            procgui::SceneRegistry::Handle to_select {};
             bool already_selected = false;
-            for (auto it = views.begin(); it != views.end(); ++it)
+            for (auto i : candidates)
             {
-                if (it->is_inside(WindowController::real_mouse_position(
-                                      {event.mouseButton.x,
-                                       event.mouseButton.y})))
+                auto handle = tree_views_.at(i);
+                auto* view = views.get(handle);
+                if (view && view->is_inside(click))
                 {
                     // If the click is inside the hitboxes, select it... 
-                    to_select = it;
-                    if (it->is_selected())
+                    to_select = handle;
+                    if (view->is_selected())
                     {
-                        under_mouse_ = &(*it);
+                        under_mouse_ = handle;
                         already_selected = true;
 
                         // ... unless an other one is selected at this
                         // position. If that's the case stop the search.
-                        to_select = views.end();
+                        to_select = {};
                         break;
                     }
 
                 }
             }
-            if (to_select != views.end())
+            if (to_select)
             {
-                under_mouse_ = &(*to_select);
+                under_mouse_ = to_select;
 
                 if (double_click)
                 {
-                    to_select->select();
+                    views.get(to_select)->select();
                 }
             }
             else if (!already_selected)
             {
-                under_mouse_ = nullptr;
+                under_mouse_ = {};
             }
         }
 
         else if (!imgui_io.WantCaptureKeyboard &&
                  event.type == sf::Event::KeyPressed &&
                  event.key.code == sf::Keyboard::Delete &&
-                 under_mouse_ &&
-                 under_mouse_->is_selected())
+                 under_mouse(views) &&
+                 under_mouse(views)->is_selected())
         {
-            delete_view(views, under_mouse_->get_id());
+            delete_view(views, under_mouse_);
         }
 
         else if (!imgui_io.WantCaptureKeyboard &&
                  event.type == sf::Event::KeyPressed &&
                  (sf::Keyboard::isKeyPressed(sf::Keyboard::LControl) ||
                   sf::Keyboard::isKeyPressed(sf::Keyboard::RControl)) &&
-                 under_mouse_ != nullptr &&
-                 under_mouse_->is_selected())
+                 under_mouse(views) &&
+                 under_mouse(views)->is_selected())
         {
             if (event.key.code == sf::Keyboard::C)
             {
-                saved_view_ = *under_mouse_;
+                saved_view_ = *under_mouse(views);
                 is_clone_ = true;
             }
             else if (event.key.code == sf::Keyboard::X)
             {
-                saved_view_ = *under_mouse_;
+                saved_view_ = *under_mouse(views);
                 is_clone_ = false;
             }
             else if (event.key.code == sf::Keyboard::S)
@@ -128,43 +144,66 @@ namespace controller
         }
     }
 
-    void LSystemController::handle_delta(sf::Vector2f delta)
+    void LSystemController::handle_delta(procgui::SceneRegistry& views, sf::Vector2f delta)
     {
-        if (under_mouse_)
+        if (auto* view = views.get(under_mouse_))
         {
-            auto& parameters = under_mouse_->ref_parameters();
+            auto& parameters = view->ref_parameters();
             auto starting_position = parameters.get_starting_position() - ext::sf::Vector2d(delta);
             parameters.set_starting_position(starting_position);
         }
     }
 
-    void LSystemController::delete_view(std::list<procgui::LSystemView>& views, int id)
+    void LSystemController::delete_view(procgui::SceneRegistry& views, procgui::SceneRegistry::Handle handle)
     {
-        auto to_delete = std::find_if(begin(views), end(views),
-                                      [id](const auto& v){return v.get_id() == id;});
-        Expects(to_delete != end(views));
-        views.erase(to_delete);
+        views.erase(handle);
+        if (handle == under_mouse_)
+        {
+            under_mouse_ = {};
+        }
     }
 
 
-    void LSystemController::right_click_menu(std::list<procgui::LSystemView>& views)
+    void LSystemController::update_views_tree(procgui::SceneRegistry& views)
+    {
+        // The tree is rebuilt lazily: most clicks happen without any
+        // modification of the views.
+        if (!tree_views_.empty() &&
+            tree_generation_ == procgui::LSystemView::bounds_generation())
+        {
+            return;
+        }
+
+        tree_views_.clear();
+        std::vector<sf::FloatRect> boxes;
+        for (std::size_t i = 0; i < views.size(); ++i)
+        {
+            tree_views_.push_back(views.handle_at(i));
+            boxes.push_back(views.views()[i].get_bounding_box());
+        }
+        geometry::expand_boxes(boxes, procgui::LSystemView::PICKING_TOLERANCE);
+        views_tree_ = geometry::BoxTree(boxes);
+        tree_generation_ = procgui::LSystemView::bounds_generation();
+    }
+
+    void LSystemController::right_click_menu(procgui::SceneRegistry& views)
     {
         if (ImGui::BeginPopupContextVoid())
         {
             // Cloning is deep-copying the LSystem.
-            if (ImGui::MenuItem("Clone", "Ctrl+C") && under_mouse_)
+            if (ImGui::MenuItem("Clone", "Ctrl+C") && under_mouse(views))
             {
-                saved_view_ = *under_mouse_;
+                saved_view_ = *under_mouse(views);
                 is_clone_ = true;
             }
-            if (ImGui::MenuItem("Duplicate", "Ctrl+X") && under_mouse_)
+            if (ImGui::MenuItem("Duplicate", "Ctrl+X") && under_mouse(views))
             {
-                saved_view_ = *under_mouse_;
+                saved_view_ = *under_mouse(views);
                 is_clone_ = false;
             }
-            if (ImGui::MenuItem("Delete", "Del") && under_mouse_)
+            if (ImGui::MenuItem("Delete", "Del") && under_mouse(views))
             {
-                delete_view(views, under_mouse_->get_id());
+                delete_view(views, under_mouse_);
             }
             ImGui::Separator();
             if (ImGui::MenuItem("Save", "Ctrl+S"))
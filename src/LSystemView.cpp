@@ -1,22 +1,70 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include "cereal/archives/json.hpp"
+#include "cereal/archives/portable_binary.hpp"
+#include "cereal/types/vector.hpp"
 #include "procgui.h"
 #include "LSystemView.h"
+#include "DiskCache.h"
 #include "helper_math.h"
+#include "Profiler.h"
 
 namespace procgui
 {
     using namespace drawing;
     using namespace colors;
 
+    namespace
+    {
+        // The headers of the binary save files of a view and of a scene,
+        // followed by the portable binary archive. The last character is the
+        // version of the format.
+        constexpr std::array<char, 8> BINARY_MAGIC {'P', 'R', 'O', 'C', 'G', 'E', 'N', '\2'};
+        constexpr std::array<char, 8> SCENE_MAGIC {'P', 'R', 'O', 'C', 'S', 'C', 'N', '\1'};
+    }
+
     // int LSystemView::id_count_ = 0;
     UniqueId LSystemView::unique_ids_ {};
     UniqueColor LSystemView::unique_colors_ {};
+    unsigned long LSystemView::bounds_generation_ {0};
+    WorkerPool LSystemView::workers_ {};
+    std::unordered_map<std::uint64_t, LSystemView::Instance> LSystemView::instances_ {};
+    std::size_t LSystemView::next_instances_sweep_ {64};
+    std::unordered_map<std::uint64_t, std::weak_ptr<LSystemView::Computation>> LSystemView::computations_ {};
 
     void LSystemView::update_callbacks()
     {
-        OLSys::add_callback([this](){compute_vertices();});
-        OMap::add_callback([this](){compute_vertices();});
-        OParams::add_callback([this](){compute_vertices();});
-        OPainter::add_callback([this](){paint_vertices();});
+        // The notifications are only marked in the scheduler, the
+        // computations are done once per frame in 'update()'.
+        OLSys::add_callback([this](){iteration_extents_.clear();
+                                     predicted_box_.reset();
+                                     scheduler_.mark(UpdateScheduler::Derive);});
+        OMap::add_callback([this](){iteration_extents_.clear();
+                                    predicted_box_.reset();
+                                    scheduler_.mark(UpdateScheduler::Interpret);});
+        OParams::add_callback([this](){params_modified();});
+        OPainter::add_callback([this](){forget_instances(OPainter::get_target().get());
+                                        is_painted_ = false;
+                                        scheduler_.mark(UpdateScheduler::Paint);});
+
+        // The rules are expanded during the interpretation: the 'Derive'
+        // stage does not have its own task.
+        scheduler_.set_task(UpdateScheduler::Derive, nullptr);
+        scheduler_.set_task(UpdateScheduler::Interpret, [this](){start_computation();});
+        // The result of a running computation is transformed at its
+        // reception.
+        scheduler_.set_task(UpdateScheduler::Transform, [this](){if (!is_computing()) transform_geometry();});
+        // If a computation is running, the new vertices will be painted at
+        // their reception. An adopted instance is already painted.
+        // Another view with the same models may have already painted them.
+        scheduler_.set_task(UpdateScheduler::Paint, [this](){if (!is_computing() && !is_painted_ && !adopt_instance()) paint_vertices();});
+
+        // Called at each creation or assignment of a LSystemView.
+        ++bounds_generation_;
     }
 
     LSystemView::LSystemView(const std::string& name,
@@ -24,6 +72,16 @@ namespace procgui
                              std::shared_ptr<InterpretationMap> map,
                              std::shared_ptr<DrawingParameters> params,
                              std::shared_ptr<VertexPainterWrapper> painter)
+        : LSystemView(name, lsys, map, params, painter, std::nullopt)
+    {
+    }
+
+    LSystemView::LSystemView(const std::string& name,
+                             std::shared_ptr<LSystem> lsys,
+                             std::shared_ptr<InterpretationMap> map,
+                             std::shared_ptr<DrawingParameters> params,
+                             std::shared_ptr<VertexPainterWrapper> painter,
+                             std::optional<Geometry>&& geometry)
         : OLSys {lsys}
         , OMap {map}
         , OParams {params}
@@ -33,19 +91,38 @@ namespace procgui
         , name_ {name}
         , lsys_buff_ {lsys}
         , interpretation_buff_ {map}
-        , vertices_ {}
-        , iteration_of_vertices_ {}
-        , max_iteration_ {0}
-        , bounding_box_ {}
-        , sub_boxes_ {}
+        , geometry_ {empty_geometry()}
         , is_selected_ {false}
+        , is_materialized_ {false}
+        , is_painted_ {false}
+        , scheduler_ {}
+        , pending_ {}
+        , is_progressive_ {false}
+        , is_adaptive_ {false}
+        , is_restricted_ {false}
+        , pixel_size_ {0}
+        , viewport_ {}
+        , predicted_box_ {}
+        , partial_ {}
+        , displayed_iteration_ {0}
+        , preview_scale_ {1.f}
+        , iteration_extents_ {}
+        , extents_parameters_ {}
     {
         // Invariant respected: cohesion between the LSystem/InterpretationMap
         // and the vertices.             
         update_callbacks();
-        
-        compute_vertices();
-        paint_vertices();
+
+        if (geometry)
+        {
+            set_geometry(std::move(*geometry));
+            paint_vertices();
+        }
+        else
+        {
+            // Lazy materialization: computed at the first update.
+            scheduler_.mark(UpdateScheduler::Interpret);
+        }
     }
 
     LSystemView::LSystemView(const ext::sf::Vector2d& position)
@@ -68,15 +145,33 @@ namespace procgui
         , name_ {other.name_}
         , lsys_buff_ {other.lsys_buff_}
         , interpretation_buff_ {other.interpretation_buff_}
-        , vertices_ {other.vertices_}
-        , iteration_of_vertices_ {other.iteration_of_vertices_}
-        , max_iteration_ {other.max_iteration_}
-        , bounding_box_ {other.bounding_box_}
-        , sub_boxes_ {other.sub_boxes_}
+        , geometry_ {other.geometry_}
         , is_selected_ {other.is_selected_}
+        , is_materialized_ {other.is_materialized_}
+        , is_painted_ {other.is_painted_}
+        , scheduler_ {other.scheduler_}
+        , pending_ {}
+        , is_progressive_ {other.is_progressive_}
+        , is_adaptive_ {other.is_adaptive_}
+        , is_restricted_ {other.is_restricted_}
+        , pixel_size_ {other.pixel_size_}
+        , viewport_ {other.viewport_}
+        , predicted_box_ {other.predicted_box_}
+        , partial_ {}
+        , displayed_iteration_ {other.displayed_iteration_}
+        , preview_scale_ {other.preview_scale_}
+        , iteration_extents_ {other.iteration_extents_}
+        , extents_parameters_ {other.extents_parameters_}
     {
         // Manually managing Observer<> callbacks.
         update_callbacks();
+
+        // The background computation of 'other' is not shared: start a new
+        // one at the next update.
+        if (other.is_computing())
+        {
+            scheduler_.mark(UpdateScheduler::Interpret);
+        }
     }
 
     LSystemView::LSystemView(LSystemView&& other)
@@ -89,12 +184,23 @@ namespace procgui
         , name_ {std::move(other.name_)}
         , lsys_buff_ {std::move(other.lsys_buff_)}
         , interpretation_buff_ {std::move(other.interpretation_buff_)}
-        , vertices_ {std::move(other.vertices_)}
-        , iteration_of_vertices_ {std::move(other.iteration_of_vertices_)}
-        , max_iteration_ {other.max_iteration_}
-        , bounding_box_ {std::move(other.bounding_box_)}
-        , sub_boxes_ {std::move(other.sub_boxes_)}
+        , geometry_ {std::move(other.geometry_)}
         , is_selected_ {other.is_selected_}
+        , is_materialized_ {other.is_materialized_}
+        , is_painted_ {other.is_painted_}
+        , scheduler_ {std::move(other.scheduler_)}
+        , pending_ {std::move(other.pending_)}
+        , is_progressive_ {other.is_progressive_}
+        , is_adaptive_ {other.is_adaptive_}
+        , is_restricted_ {other.is_restricted_}
+        , pixel_size_ {other.pixel_size_}
+        , viewport_ {other.viewport_}
+        , predicted_box_ {other.predicted_box_}
+        , partial_ {std::move(other.partial_)}
+        , displayed_iteration_ {other.displayed_iteration_}
+        , preview_scale_ {other.preview_scale_}
+        , iteration_extents_ {std::move(other.iteration_extents_)}
+        , extents_parameters_ {other.extents_parameters_}
     {
         // Manually managing Observer<> callbacks.
         update_callbacks();
@@ -108,7 +214,7 @@ namespace procgui
         // the 'other' object must not matter in the 'color_gen_' anymore.
         other.id_ = -1;
         other.color_id_ = sf::Color::Black;
-        other.bounding_box_ = {};
+        other.geometry_ = empty_geometry();
         other.is_selected_ = false;
     }
 
@@ -116,6 +222,8 @@ namespace procgui
     {
         if (this != &other)
         {
+            cancel_computation();
+
             OLSys::set_target(other.OLSys::get_target());
             OMap::set_target(other.OMap::get_target());
             OParams::set_target(other.OParams::get_target());
@@ -125,14 +233,30 @@ namespace procgui
             name_ = {other.name_};
             lsys_buff_ = {other.lsys_buff_};
             interpretation_buff_ = {other.interpretation_buff_};
-            vertices_ = {other.vertices_};
-            iteration_of_vertices_ = {other.iteration_of_vertices_};
-            max_iteration_ = {other.max_iteration_};
-            bounding_box_ = {other.bounding_box_};
-            sub_boxes_ = {other.sub_boxes_};
+            geometry_ = other.geometry_;
             is_selected_ = {other.is_selected_};
+            is_materialized_ = other.is_materialized_;
+            is_painted_ = other.is_painted_;
+            scheduler_ = {other.scheduler_};
+            is_progressive_ = other.is_progressive_;
+            is_adaptive_ = other.is_adaptive_;
+            is_restricted_ = other.is_restricted_;
+            pixel_size_ = other.pixel_size_;
+            viewport_ = other.viewport_;
+            predicted_box_ = other.predicted_box_;
+            displayed_iteration_ = other.displayed_iteration_;
+            preview_scale_ = other.preview_scale_;
+            iteration_extents_ = other.iteration_extents_;
+            extents_parameters_ = other.extents_parameters_;
 
             update_callbacks();
+
+            // The background computation of 'other' is not shared: start a
+            // new one at the next update.
+            if (other.is_computing())
+            {
+                scheduler_.mark(UpdateScheduler::Interpret);
+            }
         }
 
         return *this;
@@ -142,21 +266,39 @@ namespace procgui
     {
         if (this != &other)
         {
+            cancel_computation();
+
             OLSys::set_target(std::move(other.OLSys::get_target()));
             OMap::set_target(std::move(other.OMap::get_target()));
             OParams::set_target(std::move(other.OParams::get_target()));
             OPainter::set_target(std::move(other.OPainter::get_target()));
+            // The identifier of this view is replaced by the one of 'other'.
+            if (id_ != -1)
+            {
+                unique_ids_.free_id(id_);
+            }
             id_ = other.id_;
             color_id_ = other.color_id_;
             name_ = {std::move(other.name_)};
             lsys_buff_ = {std::move(other.lsys_buff_)};
             interpretation_buff_ = {std::move(other.interpretation_buff_)};
-            vertices_ = {std::move(other.vertices_)};
-            iteration_of_vertices_ = {std::move(other.iteration_of_vertices_)};
-            max_iteration_ = {other.max_iteration_};
-            bounding_box_ = {std::move(other.bounding_box_)};
-            sub_boxes_ = {std::move(other.sub_boxes_)};
+            geometry_ = std::move(other.geometry_);
             is_selected_ = {other.is_selected_};
+            is_materialized_ = other.is_materialized_;
+            is_painted_ = other.is_painted_;
+            scheduler_ = {std::move(other.scheduler_)};
+            pending_ = std::move(other.pending_);
+            is_progressive_ = other.is_progressive_;
+            is_adaptive_ = other.is_adaptive_;
+            is_restricted_ = other.is_restricted_;
+            pixel_size_ = other.pixel_size_;
+            viewport_ = other.viewport_;
+            predicted_box_ = other.predicted_box_;
+            partial_ = std::move(other.partial_);
+            displayed_iteration_ = other.displayed_iteration_;
+            preview_scale_ = other.preview_scale_;
+            iteration_extents_ = std::move(other.iteration_extents_);
+            extents_parameters_ = other.extents_parameters_;
 
             // Manually managing Observer<> callbacks.
             update_callbacks();
@@ -170,7 +312,7 @@ namespace procgui
             // the 'other' object must not matter in the 'color_gen_' anymore.
             other.id_ = -1;
             other.color_id_ = sf::Color::Black;
-            other.bounding_box_ = {};
+            other.geometry_ = empty_geometry();
             other.is_selected_ = false;
         }
 
@@ -180,6 +322,11 @@ namespace procgui
 
     LSystemView::~LSystemView()
     {
+        // The background computation works on its own copy of the models, it
+        // can safely be abandoned.
+        cancel_computation();
+        ++bounds_generation_;
+
         // Unregister the id unless the object was moved.
         if (id_ != -1)
         {
@@ -190,24 +337,29 @@ namespace procgui
 
     LSystemView LSystemView::clone() const
     {        
-        // Deep copy.
-        return LSystemView(
+        // Deep copy of the models. The geometry of equal models is equal: it
+        // is shared until one of the views is modified.
+        LSystemView view (
             name_,
             std::make_shared<LSystem>(*OLSys::get_target()),
             std::make_shared<InterpretationMap>(*OMap::get_target()),
             std::make_shared<DrawingParameters>(*OParams::get_target()),
             std::make_shared<VertexPainterWrapper>(OPainter::get_target()->clone())
                 );
+        view.share_geometry(*this);
+        return view;
     }
 
     LSystemView LSystemView::duplicate() const
     {
-        return LSystemView(
+        LSystemView view (
             name_,
             lsys_buff_.get_target(),
             interpretation_buff_.get_target(),
             std::make_shared<DrawingParameters>(*OParams::get_target()),
             OPainter::get_target());
+        view.share_geometry(*this);
+        return view;
     }
     
 
@@ -229,7 +381,21 @@ namespace procgui
     }
     sf::FloatRect LSystemView::get_bounding_box() const
     {
-        return get_transform().transformRect(bounding_box_);
+        return get_transform().transformRect(geometry_->bounding_box);
+    }
+    sf::FloatRect LSystemView::get_predicted_bounding_box()
+    {
+        if (is_materialized_)
+        {
+            return get_bounding_box();
+        }
+        if (!predicted_box_)
+        {
+            predicted_box_ = drawing::compute_statistics(*OLSys::get_target(),
+                                                         *OMap::get_target(),
+                                                         *OParams::get_target()).bounding_box;
+        }
+        return get_transform().transformRect(*predicted_box_);
     }
     const drawing::DrawingParameters& LSystemView::get_parameters() const
     {
@@ -255,55 +421,861 @@ namespace procgui
     {
         return color_id_;
     }
+    const UpdateScheduler& LSystemView::get_scheduler() const
+    {
+        return scheduler_;
+    }
     sf::Transform LSystemView::get_transform() const
     {
         sf::Transform transform;
         transform.translate(sf::Vector2f(OParams::get_target()->get_starting_position()));
+        // The origin of the turtle is the starting position: the preview is
+        // scaled around it.
+        transform.scale(preview_scale_, preview_scale_);
         return transform;
     }
     
-    void LSystemView::compute_vertices()
+    bool LSystemView::is_computing() const
+    {
+        return pending_ != nullptr;
+    }
+
+    bool LSystemView::is_progressive() const
+    {
+        return is_progressive_;
+    }
+    void LSystemView::set_progressive(bool progressive)
     {
+        is_progressive_ = progressive;
+    }
+
+    bool LSystemView::is_adaptive() const
+    {
+        return is_adaptive_;
+    }
+    void LSystemView::set_adaptive(bool adaptive)
+    {
+        is_adaptive_ = adaptive;
+    }
+
+    bool LSystemView::is_restricted() const
+    {
+        return is_restricted_;
+    }
+    void LSystemView::set_restricted(bool restricted)
+    {
+        is_restricted_ = restricted;
+    }
+
+    double LSystemView::min_extent() const
+    {
+        return is_adaptive_ ? pixel_size_ * ADAPTIVE_PIXELS : 0;
+    }
+
+    std::optional<sf::FloatRect> LSystemView::region() const
+    {
+        if (!is_restricted_ || viewport_.width == 0)
+        {
+            return std::nullopt;
+        }
+        // The viewport with a margin of half its size on each side, in the
+        // coordinates of the turtle.
+        auto position = sf::Vector2f(OParams::get_target()->get_starting_position());
+        return sf::FloatRect(viewport_.left - viewport_.width / 2 - position.x,
+                             viewport_.top - viewport_.height / 2 - position.y,
+                             2 * viewport_.width, 2 * viewport_.height);
+    }
+
+    bool LSystemView::is_interpreted_for_view() const
+    {
+        double current = geometry_->min_extent;
+        double desired = min_extent();
+        if (current != desired && (desired > 2 * current || current > 2 * desired))
+        {
+            return false;
+        }
+
+        const auto& computed = geometry_->region;
+        auto desired_region = region();
+        if (!computed || !desired_region)
+        {
+            return computed.has_value() == desired_region.has_value();
+        }
+        // The computed region must contain the viewport.
+        auto position = sf::Vector2f(OParams::get_target()->get_starting_position());
+        return computed->contains(viewport_.left - position.x, viewport_.top - position.y) &&
+            computed->contains(viewport_.left + viewport_.width - position.x,
+                               viewport_.top + viewport_.height - position.y);
+    }
+
+    LSystemView::Geometry LSystemView::compute_geometry(const LSystem& lsys,
+                                                        const InterpretationMap& map,
+                                                        const DrawingParameters& params,
+                                                        double min_extent,
+                                                        const std::optional<sf::FloatRect>& region,
+                                                        const std::atomic<bool>* cancelled,
+                                                        PartialGeometry* partial)
+    {
+        // Publish the partial geometry each time the number of vertices has
+        // doubled: the copies stay in O(n) in total.
+        std::size_t next_publication = 1024;
+        drawing::partial_fn publish = nullptr;
+        if (partial)
+        {
+            publish = [partial, &next_publication](const auto& vertices, const auto& iterations, int max)
+            {
+                if (vertices.size() < next_publication)
+                {
+                    return;
+                }
+                next_publication = 2 * vertices.size();
+
+                Geometry geometry;
+                geometry.vertices = vertices;
+                geometry.iteration_of_vertices = iterations;
+                geometry.max_iteration = max;
+                compute_boxes(geometry);
+                geometry.is_complete = false;
+
+                std::lock_guard<std::mutex> lock (partial->mutex);
+                partial->geometry = std::move(geometry);
+            };
+        }
+
         // Invariant respected: cohesion between the vertices and the bounding
         // boxes. 
-        
-        std::tie(vertices_, iteration_of_vertices_, max_iteration_) =
-            drawing::compute_vertices(*OLSys::get_target(),
+        Geometry geometry;
+        std::string disk_identity = DiskCache::geometry_identity(lsys, map, params);
+        std::uint64_t disk_key = DiskCache::key(disk_identity);
+        if (min_extent > 0 || region)
+        {
+            // Depends on the view: not stored in the DiskCache.
+            Profiler::Scope scope ("drawing::compute_vertices_adaptive");
+            std::tie(geometry.vertices, geometry.iteration_of_vertices, geometry.max_iteration) =
+                drawing::compute_vertices_adaptive(lsys, map, params, min_extent, region,
+                                                   cancelled, publish);
+            scope.set_items(geometry.vertices.size());
+        }
+        else if (auto entry = DiskCache::find(disk_key, disk_identity); entry && entry->n_blocks() == 3 &&
+            entry->block<int>(1).size() == entry->block<sf::Vertex>(0).size() &&
+            entry->block<int>(2).size() == 1)
+        {
+            // Computed in a previous session: neither derived nor interpreted.
+            // The geometry keeps the mapping of the entry.
+            Profiler::Scope scope ("DiskCache::find");
+            auto vertices = entry->block<sf::Vertex>(0);
+            geometry.vertices.assign(vertices.begin(), vertices.end());
+            geometry.max_iteration = entry->block<int>(2)[0];
+            geometry.cache_entry = std::make_shared<const DiskCache::Entry>(std::move(*entry));
+            scope.set_items(geometry.vertices.size());
+        }
+        else if (auto statistics = drawing::compute_statistics(lsys, map, params, false, cancelled);
+                 statistics.vertices > MAX_VERTICES)
+        {
+            // Would not fit in memory: the adaptive and restricted modes can
+            // still compute it.
+            geometry.refused_vertices = statistics.vertices;
+        }
+        else
+        {
+            {
+                // Includes the expansion of the rules of the LSystem.
+                Profiler::Scope scope ("drawing::compute_vertices");
+                std::tie(geometry.vertices, geometry.iteration_of_vertices, geometry.max_iteration) =
+                    drawing::compute_vertices(lsys, map, params, cancelled, publish);
+                scope.set_items(geometry.vertices.size());
+            }
+            // A cancelled computation is incomplete.
+            if (!cancelled || !*cancelled)
+            {
+                DiskCache::store(disk_key, disk_identity,
+                                 {gsl::as_bytes(gsl::make_span(geometry.vertices)),
+                                  gsl::as_bytes(gsl::make_span(geometry.iteration_of_vertices)),
+                                  gsl::as_bytes(gsl::make_span(&geometry.max_iteration, 1))});
+            }
+        }
+        // The result of a cancelled computation is never received.
+        if (cancelled && *cancelled)
+        {
+            return geometry;
+        }
+        compute_boxes(geometry);
+        geometry.n_iter = params.get_n_iter();
+        geometry.step = params.get_step();
+        geometry.starting_angle = params.get_starting_angle();
+        geometry.min_extent = min_extent;
+        geometry.region = region;
+        return geometry;
+    }
+
+    void LSystemView::compute_boxes(Geometry& geometry)
+    {
+        const auto& vertices = geometry.vertices;
+        Profiler::Scope scope ("LSystemView::compute_boxes", vertices.size());
+        geometry.bounding_box = geometry::bounding_box(vertices);
+        geometry.chunk_boxes = geometry::chunk_boxes(vertices, CHUNK_SIZE);
+
+        std::vector<sf::FloatRect> segment_boxes;
+        if (vertices.size() > 1)
+        {
+            segment_boxes.reserve(vertices.size() - 1);
+            for (std::size_t i = 0; i < vertices.size() - 1; ++i)
+            {
+                const auto& a = vertices[i].position;
+                const auto& b = vertices[i+1].position;
+                segment_boxes.push_back({std::min(a.x, b.x), std::min(a.y, b.y),
+                                         std::abs(b.x - a.x), std::abs(b.y - a.y)});
+            }
+        }
+        geometry.segment_tree = geometry::BoxTree(segment_boxes);
+    }
+
+    void LSystemView::set_geometry(Geometry&& geometry)
+    {
+        // A computed geometry is not painted yet.
+        set_geometry(std::make_shared<Geometry>(std::move(geometry)));
+        is_painted_ = false;
+    }
+
+    void LSystemView::set_geometry(std::shared_ptr<Geometry> geometry)
+    {
+        // The previous geometry is not modified: the views sharing it keep
+        // it.
+        geometry_ = std::move(geometry);
+        ++bounds_generation_;
+
+        // The new geometry is displayed as is, without preview.
+        preview_scale_ = 1.f;
+        displayed_iteration_ = geometry_->is_complete ? geometry_->n_iter : -1;
+        if (geometry_->is_complete)
+        {
+            is_materialized_ = true;
+        }
+        if (geometry_->is_complete && !geometry_->region && !geometry_->refused_vertices)
+        {
+            check_iteration_extents();
+            const auto& box = geometry_->bounding_box;
+            iteration_extents_[geometry_->n_iter] = std::max(box.width, box.height);
+        }
+    }
+    
+    void LSystemView::compute_vertices()
+    {
+        // The synchronous computation supersedes any background one.
+        cancel_computation();
+        Profiler::Context context (id_);
+        set_geometry(compute_geometry(*OLSys::get_target(),
                                       *OMap::get_target(),
-                                      *OParams::get_target());
-        bounding_box_ = geometry::bounding_box(vertices_);
-        sub_boxes_ = geometry::sub_boxes(vertices_, MAX_SUB_BOXES);
-        geometry::expand_boxes(sub_boxes_);
+                                      *OParams::get_target(),
+                                      min_extent(),
+                                      region()));
+    }
+
+    std::uint64_t LSystemView::get_refused_vertices() const
+    {
+        return geometry_->refused_vertices;
+    }
+
+    LSystemView::Geometry& LSystemView::edit_geometry()
+    {
+        // Copy-on-write.
+        if (geometry_.use_count() > 1)
+        {
+            geometry_ = std::make_shared<Geometry>(*geometry_);
+        }
+        return *geometry_;
+    }
+
+    void LSystemView::share_geometry(const LSystemView& other)
+    {
+        geometry_ = other.geometry_;
+        is_materialized_ = other.is_materialized_;
+        is_painted_ = other.is_painted_;
+        displayed_iteration_ = other.displayed_iteration_;
+        preview_scale_ = other.preview_scale_;
+        iteration_extents_ = other.iteration_extents_;
+        extents_parameters_ = other.extents_parameters_;
+        ++bounds_generation_;
+
+        // An outdated or partial geometry is computed again at the next
+        // update, as for a copy.
+        if (other.is_materialized_ && !other.is_computing() && !other.scheduler_.is_dirty())
+        {
+            scheduler_.clear();
+        }
+    }
+
+    const std::shared_ptr<LSystemView::Geometry>& LSystemView::empty_geometry()
+    {
+        // Never modified: always shared by at least this pointer.
+        static const auto empty = std::make_shared<Geometry>();
+        return empty;
+    }
+
+    std::string LSystemView::instance_identity() const
+    {
+        auto identity = DiskCache::geometry_identity(*OLSys::get_target(),
+                                                     *OMap::get_target(),
+                                                     *OParams::get_target());
+        if (auto extent = min_extent(); extent > 0)
+        {
+            int exponent = std::ilogb(extent);
+            identity.append(reinterpret_cast<const char*>(&exponent), sizeof(exponent));
+        }
+        return identity;
+    }
+
+    std::uint64_t LSystemView::instance_key(const std::string& identity) const
+    {
+        auto key = DiskCache::key(identity);
+        // The same models painted by different painters are different
+        // instances.
+        auto painter = std::hash<const void*>()(OPainter::get_target().get());
+        key ^= painter * 0x9e3779b97f4a7c15 + (key << 6) + (key >> 2);
+        if (region())
+        {
+            // Never registered: a restricted view computes its own geometry.
+            key = ~key;
+        }
+        return key;
+    }
+
+    bool LSystemView::adopt_instance()
+    {
+        auto identity = instance_identity();
+        auto it = instances_.find(instance_key(identity));
+        if (it == end(instances_))
+        {
+            return false;
+        }
+        auto instance = it->second.geometry.lock();
+        if (!instance || it->second.painter.lock() != OPainter::get_target() ||
+            it->second.identity != identity)
+        {
+            return false;
+        }
+
+        // The instance supersedes any computation. If it is already the
+        // geometry of this view (only the starting position changed),
+        // nothing is done.
+        cancel_computation();
+        if (instance != geometry_)
+        {
+            set_geometry(std::move(instance));
+            is_painted_ = true;
+        }
+        return true;
+    }
+
+    void LSystemView::register_instance()
+    {
+        // A partial or outdated geometry is not an instance, nor a geometry
+        // restricted to the region visible by this view.
+        if (!geometry_->is_complete || geometry_->region || !is_painted_ ||
+            is_computing() || scheduler_.is_dirty())
+        {
+            return;
+        }
+
+        if (instances_.size() >= next_instances_sweep_)
+        {
+            for (auto it = begin(instances_); it != end(instances_);)
+            {
+                it = it->second.geometry.expired() ? instances_.erase(it) : std::next(it);
+            }
+            next_instances_sweep_ = std::max<std::size_t>(64, 2 * instances_.size());
+        }
+        auto identity = instance_identity();
+        auto key = instance_key(identity);
+        instances_[key] = {geometry_, OPainter::get_target(), std::move(identity)};
+    }
+
+    void LSystemView::forget_instances(const VertexPainterWrapper* painter)
+    {
+        for (auto it = begin(instances_); it != end(instances_);)
+        {
+            it = it->second.painter.lock().get() == painter ? instances_.erase(it) : std::next(it);
+        }
+    }
+
+    void LSystemView::shutdown_workers()
+    {
+        workers_.shutdown();
+    }
+
+    bool LSystemView::is_materialized() const
+    {
+        return is_materialized_;
+    }
+
+    void LSystemView::materialize()
+    {
+        if (is_materialized_)
+        {
+            return;
+        }
+
+        if (adopt_instance())
+        {
+            // Another view with the same models already computed and painted
+            // it.
+            scheduler_.clear();
+            return;
+        }
+        else if (is_computing() && !scheduler_.is_dirty() && pending_->result.valid())
+        {
+            // Prefetched: the models did not change since.
+            auto computation = std::move(pending_);
+            partial_ = nullptr;
+            set_geometry(computation->result.get());
+        }
+        else
+        {
+            compute_vertices();
+            // The geometry corresponds to the latest models.
+            scheduler_.clear();
+        }
         paint_vertices();
     }
 
+    void LSystemView::prefetch()
+    {
+        if (!is_materialized_ && !is_computing())
+        {
+            scheduler_.clear();
+            start_computation();
+        }
+    }
+
+    void LSystemView::start_computation()
+    {
+        // Another view with the same models already computed and painted the
+        // geometry.
+        if (adopt_instance())
+        {
+            return;
+        }
+
+        // Only the latest modification matters.
+        cancel_computation();
+
+        // Another view with the same models is already computing the
+        // geometry: its result will be adopted.
+        auto identity = instance_identity();
+        auto key = instance_key(identity);
+        bool is_shared = !is_progressive_ && !region();
+        if (auto it = computations_.find(key); is_shared && it != end(computations_))
+        {
+            if (auto computation = it->second.lock();
+                computation && computation->result.valid() && computation->identity == identity)
+            {
+                pending_ = std::move(computation);
+                return;
+            }
+        }
+
+        // The worker computes on a snapshot of the models: they can be
+        // modified by the GUI during the computation. Only the axiom, the
+        // rules and the iteration predecessors of the LSystem are copied, not
+        // its cache of productions: the rules are expanded during the
+        // interpretation, nothing is derived into the snapshot.
+        const auto& target = *OLSys::get_target();
+        pending_ = std::make_shared<Computation>();
+        partial_ = is_progressive_ ? std::make_shared<PartialGeometry>() : nullptr;
+        pending_->result = workers_.submit(
+            [lsys = LSystem(target.get_axiom(), target.get_rules(), target.get_iteration_predecessors()),
+             map = *OMap::get_target(),
+             params = *OParams::get_target(),
+             min_extent = min_extent(),
+             region = region(),
+             cancelled = pending_->cancelled,
+             partial = partial_,
+             id = id_]()
+            {
+                Profiler::Context context (id);
+                return compute_geometry(lsys, map, params, min_extent, region,
+                                        cancelled.get(), partial.get());
+            });
+        if (is_shared)
+        {
+            for (auto it = begin(computations_); it != end(computations_);)
+            {
+                it = it->second.expired() ? computations_.erase(it) : std::next(it);
+            }
+            pending_->identity = std::move(identity);
+            computations_[key] = pending_;
+        }
+
+        // Progressive mode: the previous drawing is immediately scaled to the
+        // estimated size of the new one. 
+        if (is_progressive_ && displayed_iteration_ >= 0)
+        {
+            preview_scale_ = estimate_scale(displayed_iteration_,
+                                            OParams::get_target()->get_n_iter());
+            ++bounds_generation_;
+        }
+    }
+
+    void LSystemView::transform_geometry()
+    {
+        const auto& params = *OParams::get_target();
+        if (is_computing() || !is_materialized_ || !geometry_->is_complete ||
+            (params.get_step() == geometry_->step &&
+             params.get_starting_angle() == geometry_->starting_angle))
+        {
+            return;
+        }
+        if (adopt_instance())
+        {
+            return;
+        }
+        if (geometry_->step == 0 || geometry_->region)
+        {
+            // The drawing was reduced to a point: it can not be scaled back.
+            // A restricted drawing would not cover the region anymore.
+            start_computation();
+            return;
+        }
+
+        Profiler::Context context (id_);
+        Profiler::Scope scope ("LSystemView::transform_geometry", geometry_->vertices.size());
+
+        // The turtle starts at the origin: the drawing is scaled by the ratio
+        // of the steps and rotated by the difference of the angles around
+        // it (the y-axis of the screen is downward). Copy-on-write: a shared
+        // geometry is not modified.
+        double scale = params.get_step() / geometry_->step;
+        double rotation = params.get_starting_angle() - geometry_->starting_angle;
+        double cos = scale * std::cos(rotation);
+        double sin = scale * std::sin(rotation);
+        Geometry geometry = geometry_.use_count() > 1 ? *geometry_ : std::move(*geometry_);
+        for (auto& vertex : geometry.vertices)
+        {
+            double x = vertex.position.x;
+            double y = vertex.position.y;
+            vertex.position = {static_cast<float>(x * cos + y * sin),
+                               static_cast<float>(y * cos - x * sin)};
+        }
+        geometry.step = params.get_step();
+        geometry.starting_angle = params.get_starting_angle();
+        geometry.min_extent *= scale;
+        // The level-of-detail pyramid is built again after the painting.
+        geometry.lod_levels = nullptr;
+        geometry.lod_pending = nullptr;
+        compute_boxes(geometry);
+        set_geometry(std::move(geometry));
+    }
+
+    LSystemView::Computation::~Computation()
+    {
+        *cancelled = true;
+    }
+
+    void LSystemView::cancel_computation()
+    {
+        partial_ = nullptr;
+        pending_ = nullptr;
+    }
+
+    void LSystemView::receive_computation()
+    {
+        if (!is_computing())
+        {
+            return;
+        }
+        
+        if (!pending_->result.valid())
+        {
+            // The result was taken by another view sharing the computation:
+            // its geometry is adopted if it is registered as an instance, or
+            // computed again if this other view was modified in the meantime.
+            cancel_computation();
+            start_computation();
+        }
+        else if (pending_->result.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            // Another view with the same models may have already received
+            // and painted them.
+            if (adopt_instance())
+            {
+                return;
+            }
+
+            // Double-buffering: the previous vertices were drawn until now.
+            auto computation = std::move(pending_);
+            partial_ = nullptr;
+            set_geometry(computation->result.get());
+            // The step or the starting angle may have been modified during
+            // the computation.
+            transform_geometry();
+            paint_vertices();
+        }
+        else if (partial_)
+        {
+            // Progressive mode: display the latest partial geometry.
+            std::optional<Geometry> geometry;
+            {
+                std::lock_guard<std::mutex> lock (partial_->mutex);
+                geometry.swap(partial_->geometry);
+            }
+            if (geometry)
+            {
+                set_geometry(std::move(*geometry));
+                paint_vertices();
+            }
+        }
+    }
+
+    float LSystemView::estimate_scale(int from, int to) const
+    {
+        if (from == to)
+        {
+            return 1.f;
+        }
+
+        // The exact scale is known if both iterations were already computed.
+        auto from_extent = iteration_extents_.find(from);
+        auto to_extent = iteration_extents_.find(to);
+        if (from_extent == end(iteration_extents_) || from_extent->second <= 0.f)
+        {
+            return 1.f;
+        }
+        if (to_extent != end(iteration_extents_))
+        {
+            return to_extent->second / from_extent->second;
+        }
+
+        // Otherwise, extrapolate the growth between 'from' and the closest
+        // iteration computed before it.
+        if (from_extent == begin(iteration_extents_))
+        {
+            return 1.f;
+        }
+        auto previous_extent = std::prev(from_extent);
+        if (previous_extent->second <= 0.f)
+        {
+            return 1.f;
+        }
+        double growth = std::pow(from_extent->second / previous_extent->second,
+                                 1. / (from_extent->first - previous_extent->first));
+        return std::pow(growth, to - from);
+    }
+
+    void LSystemView::params_modified()
+    {
+        // Any modification moves the screen-space bounding box.
+        ++bounds_generation_;
+        switch (OParams::get_target()->get_last_modified())
+        {
+        case DrawingParameters::StartingPosition:
+            // Only used by 'get_transform()'.
+            break;
+
+        case DrawingParameters::StartingAngle:
+        case DrawingParameters::Step:
+            check_iteration_extents();
+            predicted_box_.reset();
+            scheduler_.mark(UpdateScheduler::Transform);
+            break;
+
+        case DrawingParameters::DeltaAngle:
+        case DrawingParameters::NIter:
+        case DrawingParameters::Several:
+            check_iteration_extents();
+            predicted_box_.reset();
+            scheduler_.mark(UpdateScheduler::Interpret);
+            break;
+        }
+    }
+
+    void LSystemView::check_iteration_extents()
+    {
+        const auto& params = *OParams::get_target();
+        std::array<double, 3> parameters {params.get_starting_angle(),
+                                          params.get_delta_angle(),
+                                          params.get_step()};
+        if (parameters != extents_parameters_)
+        {
+            iteration_extents_.clear();
+            extents_parameters_ = parameters;
+        }
+    }
+
     void LSystemView::paint_vertices()
     {
-        // un-transformed vertices and bounding box
-        OPainter::get_target()->get_target()->paint_vertices(vertices_,
-                                                             iteration_of_vertices_,
-                                                             max_iteration_,
-                                                             bounding_box_);
+        Profiler::Context context (id_);
+        {
+            auto& painted = edit_geometry();
+            Profiler::Scope scope ("LSystemView::paint_vertices", painted.vertices.size());
+            // un-transformed vertices and bounding box
+            OPainter::get_target()->get_target()->paint_vertices(painted.vertices,
+                                                                 painted.iterations(),
+                                                                 painted.max_iteration,
+                                                                 painted.bounding_box);
+        }
+        build_lod_levels();
+        is_painted_ = true;
+        register_instance();
+    }
+
+    void LSystemView::build_lod_levels()
+    {
+        // The pyramid of the previous colors is outdated. Replacing
+        // 'lod_pending' cancels the previous build if no other geometry
+        // waits for it.
+        auto& painted = edit_geometry();
+        painted.lod_levels = nullptr;
+
+        // The worker only sees an immutable snapshot of the vertices, so the
+        // geometry itself is not shared with it and is not copied at the next
+        // modification.
+        auto build = std::make_shared<LodBuild>();
+        build->vertices = std::make_shared<const std::vector<sf::Vertex>>(painted.vertices);
+        build->result = workers_.submit(
+            [snapshot = std::weak_ptr<const std::vector<sf::Vertex>>(build->vertices),
+             cancelled = build->cancelled, id = id_]()
+            {
+                auto vertices = snapshot.lock();
+                if (!vertices || *cancelled)
+                {
+                    return LevelsOfDetail(nullptr);
+                }
+                Profiler::Context context (id);
+                Profiler::Scope scope ("LSystemView::build_lod_levels", vertices->size());
+                return LevelsOfDetail(std::make_shared<const std::vector<LevelOfDetail>>(
+                                          compute_lod_levels(*vertices, cancelled.get())));
+            }).share();
+        painted.lod_pending = std::move(build);
+    }
+
+    LSystemView::LodBuild::~LodBuild()
+    {
+        *cancelled = true;
+    }
+
+    std::vector<LSystemView::LevelOfDetail> LSystemView::compute_lod_levels(const std::vector<sf::Vertex>& vertices,
+                                                                            const std::atomic<bool>* cancelled)
+    {
+        // A level not simpler than the previous one is not kept.
+        std::vector<LevelOfDetail> lod_levels;
+        std::size_t previous_size = vertices.size();
+        float tolerance = LOD_BASE_TOLERANCE;
+        for (int i = 1; i < MAX_LOD_LEVELS && previous_size > 2; ++i, tolerance *= 2)
+        {
+            if (cancelled && *cancelled)
+            {
+                break;
+            }
+
+            auto simplified = geometry::simplify(vertices, tolerance, LOD_COLOR_TOLERANCE);
+            if (simplified.size() == previous_size)
+            {
+                continue;
+            }
+
+            previous_size = simplified.size();
+            auto boxes = geometry::chunk_boxes(simplified, CHUNK_SIZE);
+            lod_levels.push_back({tolerance, std::move(simplified), std::move(boxes)});
+        }
+        return lod_levels;
+    }
+
+    void LSystemView::receive_lod_levels(Geometry& geometry)
+    {
+        if (geometry.lod_pending &&
+            geometry.lod_pending->result.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            geometry.lod_levels = geometry.lod_pending->result.get();
+            geometry.lod_pending = nullptr;
+        }
+    }
+
+    void LSystemView::update()
+    {
+        scheduler_.flush();
+        receive_computation();
     }
 
     
     void LSystemView::draw(sf::RenderTarget &target)
     {
+        Profiler::Context context (id_);
+        Profiler::Scope scope ("LSystemView::draw");
+
         // Interact with the models.
         interact_with(*this, name_, &is_selected_);
 
+        // Adaptive and restricted modes: interpret again if the view changed
+        // too much since the latest interpretation (or if a mode was
+        // toggled). Checked once the current computation is received.
+        const auto& view = target.getView();
+        sf::FloatRect viewport (view.getCenter() - view.getSize() / 2.f, view.getSize());
+        pixel_size_ = view.getSize().x / target.getSize().x;
+        viewport_ = viewport;
+        if (is_materialized_ && !is_computing() && !scheduler_.is_dirty() &&
+            !is_interpreted_for_view())
+        {
+            scheduler_.mark(UpdateScheduler::Interpret);
+        }
+
+        // Culling of a view never materialized nor prefetched: its geometry
+        // is not computed as long as its predicted drawing is outside of the
+        // viewport.
+        if (!is_materialized_ && !is_computing() &&
+            !geometry::overlap(get_predicted_bounding_box(), viewport))
+        {
+            return;
+        }
+
+        // Apply all the modifications of this frame at once.
+        update();
+
         // Early out if there are no vertices.
-        if (vertices_.size() == 0)
+        // The geometry is kept alive during the drawing.
+        auto drawn = geometry_;
+        if (drawn->vertices.size() == 0)
+        {
+            return;
+        }
+
+        // Culling: early out if the drawing is outside of the viewport.
+        auto transform = get_transform();
+        auto box = transform.transformRect(drawn->bounding_box);
+        if (!geometry::overlap(box, viewport))
         {
             return;
         }
 
-        // Draw the vertices.
-        target.draw(vertices_.data(), vertices_.size(), sf::LineStrip, get_transform());
+        // Level of detail: select the simplest level whose error is less than
+        // half a pixel. Until the pyramid is built, the vertices are drawn.
+        receive_lod_levels(*drawn);
+        float pixel_size = view.getSize().x / target.getSize().x / preview_scale_;
+        const auto* vertices = &drawn->vertices;
+        const auto* chunk_boxes = &drawn->chunk_boxes;
+        for (std::size_t i = 0; drawn->lod_levels && i < drawn->lod_levels->size(); ++i)
+        {
+            const auto& level = (*drawn->lod_levels)[i];
+            if (level.tolerance > pixel_size / 2)
+            {
+                break;
+            }
+            vertices = &level.vertices;
+            chunk_boxes = &level.chunk_boxes;
+        }
+
+        // Draw only the chunks of vertices inside the viewport.
+        auto local_viewport = transform.getInverse().transformRect(viewport);
+        auto ranges = geometry::visible_ranges(*chunk_boxes, CHUNK_SIZE, vertices->size(), local_viewport);
+        unsigned long submitted = 0;
+        for (const auto& [first, count] : ranges)
+        {
+            target.draw(vertices->data() + first, count, sf::LineStrip, transform);
+            submitted += count;
+        }
+        scope.set_items(submitted);
 
         if (is_selected_)
         {
-            auto box = get_transform().transformRect(bounding_box_);
             // Draw the global bounding boxes with the unique color.
             std::array<sf::Vertex, 5> rect =
                 {{ {{ box.left, box.top}, color_id_},
@@ -315,8 +1287,8 @@ namespace procgui
         }
 
         // // DEBUG
-        // // Draw the sub-bounding boxes.
-        // for (const auto& box : sub_boxes_)
+        // // Draw the chunk bounding boxes.
+        // for (const auto& box : geometry_->chunk_boxes)
         // {
         //     std::array<sf::Vertex, 5> rect =
         //         {{ {{ box.left, box.top}, sf::Color(255,0,0,50)},
@@ -334,23 +1306,199 @@ namespace procgui
 
     bool LSystemView::is_inside(const sf::Vector2f& click) const
     {
-        decltype(sub_boxes_) subs;
-        for (const auto& box : sub_boxes_)
+        // Early out if the click is far from the bounding box.
+        auto transform = get_transform();
+        const auto& current = *geometry_;
+        auto box = transform.transformRect(current.bounding_box);
+        if (!geometry::overlap(box, {click.x - PICKING_TOLERANCE, click.y - PICKING_TOLERANCE,
+                                     2 * PICKING_TOLERANCE, 2 * PICKING_TOLERANCE}))
+        {
+            return false;
+        }
+
+        // Search a visible segment close to the click in local coordinates.
+        auto local_click = transform.getInverse().transformPoint(click);
+        float tolerance = PICKING_TOLERANCE / preview_scale_;
+        auto [segment, distance] =
+            current.segment_tree.nearest(local_click, tolerance,
+                                  [&current, &local_click](std::size_t i)
+                                  {
+                                      const auto& a = current.vertices[i];
+                                      const auto& b = current.vertices[i+1];
+                                      // Moves without drawing are not visible.
+                                      if (a.color.a == 0 && b.color.a == 0)
+                                      {
+                                          return std::numeric_limits<float>::infinity();
+                                      }
+                                      auto projection = geometry::project_and_clamp(a.position, b.position, local_click);
+                                      return geometry::distance(projection, local_click);
+                                  });
+        return segment < current.segment_tree.size() && distance <= tolerance;
+    }
+
+    unsigned long LSystemView::bounds_generation()
+    {
+        return bounds_generation_;
+    }
+    
+    void LSystemView::select()
+    {
+        is_selected_ = true;
+    }
+
+    void LSystemView::save_file(std::ostream& os, SaveFormat format, bool embed_geometry) const
+    {
+        auto saved = to_saved_view(embed_geometry, false);
+        if (format == SaveFormat::JSON)
         {
-            subs.push_back(get_transform().transformRect(box));
+            cereal::JSONOutputArchive archive (os);
+            archive(cereal::make_nvp("LSystemView", saved));
+            return;
         }
-        for (const auto& rect : subs)
+
+        os.write(BINARY_MAGIC.data(), BINARY_MAGIC.size());
+        cereal::PortableBinaryOutputArchive archive (os);
+        archive(saved);
+    }
+
+    LSystemView LSystemView::load_file(std::istream& is)
+    {
+        // The models are loaded without constructing a LSystemView: the
+        // geometry is either loaded or computed only once.
+        SavedView saved;
+        saved.with_position = false;
+
+        // The binary files start with 'BINARY_MAGIC', the JSON ones with '{'.
+        std::array<char, BINARY_MAGIC.size()> magic {};
+        is.read(magic.data(), magic.size());
+        if (!is || !std::equal(begin(magic), end(magic), begin(BINARY_MAGIC)))
         {
-            if (rect.contains(sf::Vector2f(click)))
+            is.clear();
+            is.seekg(0);
+            cereal::JSONInputArchive archive (is);
+            archive(saved);
+        }
+        else
+        {
+            cereal::PortableBinaryInputArchive archive (is);
+            archive(saved);
+        }
+        return from_saved_view(std::move(saved));
+    }
+
+    void LSystemView::save_scene(std::ostream& os,
+                                 const std::vector<LSystemView>& views,
+                                 SaveFormat format,
+                                 bool embed_geometry)
+    {
+        std::vector<SavedView> scene;
+        scene.reserve(views.size());
+        for (const auto& view : views)
+        {
+            scene.push_back(view.to_saved_view(embed_geometry, true));
+        }
+
+        if (format == SaveFormat::JSON)
+        {
+            cereal::JSONOutputArchive archive (os);
+            archive(cereal::make_nvp("Scene", scene));
+            return;
+        }
+
+        os.write(SCENE_MAGIC.data(), SCENE_MAGIC.size());
+        cereal::PortableBinaryOutputArchive archive (os);
+        archive(scene);
+    }
+
+    bool LSystemView::is_scene(std::istream& is)
+    {
+        auto position = is.tellg();
+        std::array<char, SCENE_MAGIC.size()> magic {};
+        is.read(magic.data(), magic.size());
+        bool binary = is && std::equal(begin(magic), end(magic), begin(SCENE_MAGIC));
+        is.clear();
+        is.seekg(position);
+        if (binary)
+        {
+            return true;
+        }
+
+        // A JSON scene starts with '{"Scene"', with any whitespace.
+        std::string prefix;
+        char c;
+        while (prefix.size() < 8 && is.get(c))
+        {
+            if (!std::isspace(static_cast<unsigned char>(c)))
             {
-                return true;
+                prefix.push_back(c);
             }
         }
-        return false;
+        is.clear();
+        is.seekg(position);
+        return prefix == "{\"Scene\"";
     }
-    
-    void LSystemView::select()
+
+    std::vector<LSystemView> LSystemView::load_scene(std::istream& is)
     {
-        is_selected_ = true;
+        Profiler::Scope scope ("LSystemView::load_scene");
+
+        std::vector<SavedView> scene;
+        std::array<char, SCENE_MAGIC.size()> magic {};
+        is.read(magic.data(), magic.size());
+        if (!is || !std::equal(begin(magic), end(magic), begin(SCENE_MAGIC)))
+        {
+            is.clear();
+            is.seekg(0);
+            cereal::JSONInputArchive archive (is);
+            archive(cereal::make_nvp("Scene", scene));
+        }
+        else
+        {
+            cereal::PortableBinaryInputArchive archive (is);
+            archive(scene);
+        }
+        scope.set_items(scene.size());
+
+        // The views are constructed sequentially: the identifiers and colors
+        // are not thread-safe. The geometries not embedded are then computed
+        // in parallel in the background.
+        std::vector<LSystemView> views;
+        views.reserve(scene.size());
+        for (auto& saved : scene)
+        {
+            views.push_back(from_saved_view(std::move(saved)));
+            views.back().prefetch();
+        }
+        return views;
+    }
+
+    LSystemView::SavedView LSystemView::to_saved_view(bool embed_geometry, bool with_position) const
+    {
+        // A partial or outdated geometry is not embedded.
+        // An adaptive geometry depends on the zoom: it is not embedded
+        // either.
+        embed_geometry = embed_geometry &&
+            !is_computing() && !scheduler_.is_dirty() &&
+            geometry_->min_extent == 0 && !geometry_->region && !geometry_->refused_vertices &&
+            displayed_iteration_ == OParams::get_target()->get_n_iter();
+
+        SavedView saved;
+        saved.name = name_;
+        saved.lsys = OLSys::get_target();
+        saved.params = OParams::get_target();
+        saved.map = OMap::get_target();
+        saved.with_position = with_position;
+        saved.geometry_of = embed_geometry ? this : nullptr;
+        return saved;
+    }
+
+    LSystemView LSystemView::from_saved_view(SavedView&& saved)
+    {
+        return LSystemView(saved.name,
+                           saved.lsys,
+                           saved.map,
+                           saved.params,
+                           std::make_shared<VertexPainterWrapper>(),
+                           std::move(saved.geometry));
     }
 }
@@ -1,5 +1,43 @@
+#include <algorithm>
+#include <tuple>
 #include "Observable.h"
 
+Observable::Slot::~Slot()
+{
+    disconnect();
+}
+
+// Exception:
+//  - Precondition: 'f' must not be a nullptr.
+void Observable::Slot::connect(Observable& observable, Callback f)
+{
+    Expects(f);
+    callback_ = f;
+    if (observable_ != &observable)
+    {
+        disconnect();
+        observable.link(*this);
+    }
+}
+
+void Observable::Slot::disconnect()
+{
+    if (observable_)
+    {
+        observable_->unlink(*this);
+    }
+}
+
+bool Observable::Slot::is_connected() const
+{
+    return observable_ != nullptr;
+}
+
+Observable::~Observable()
+{
+    disconnect_all();
+}
+
 Observable::Observable(const Observable&)
     : Observable{}
 {
@@ -8,17 +46,26 @@ Observable::Observable(const Observable&)
 Observable::Observable(Observable&& other)
     : Observable{}
 {
+    // The slots are not moved: they are only relinked to this Observable.
+    first_ = other.first_;
+    last_ = other.last_;
+    for (Slot* slot = first_; slot; slot = slot->next_)
+    {
+        slot->observable_ = this;
+    }
     id_ = other.id_;
-    observers_ = other.observers_;
-    
+    owned_slots_.splice(owned_slots_.end(), other.owned_slots_);
+
+    other.first_ = nullptr;
+    other.last_ = nullptr;
     other.id_ = {0};
-    other.observers_ = {};
 }
 
 Observable& Observable::operator=(Observable)
 {
+    disconnect_all();
+    owned_slots_.clear();
     id_ = {0};
-    observers_ = {};
     return *this;
 }
 
@@ -27,7 +74,10 @@ Observable& Observable::operator=(Observable)
 int Observable::add_observer(callback f)
 {
     Expects(f);
-    observers_[id_] = f;
+    owned_slots_.emplace_back(std::piecewise_construct,
+                              std::forward_as_tuple(id_),
+                              std::forward_as_tuple());
+    owned_slots_.back().second.connect(*this, f);
     return id_++;
 }
 
@@ -35,14 +85,100 @@ int Observable::add_observer(callback f)
 //  - Precondition: 'id' must be a previously given identifier.
 void Observable::remove_observer(int id)
 {
-    Expects(observers_.count(id) > 0);
-    observers_.erase(id);
+    auto it = std::find_if(begin(owned_slots_), end(owned_slots_),
+                           [id](const auto& owned){return owned.first == id;});
+    Expects(it != end(owned_slots_));
+    owned_slots_.erase(it);
 }
 
-void Observable::notify() const
+bool Observable::has_observers() const
 {
-    for(const auto& p : observers_)
+    return first_ != nullptr;
+}
+
+void Observable::link(Slot& slot)
+{
+    slot.observable_ = this;
+    slot.previous_ = last_;
+    slot.next_ = nullptr;
+    (last_ ? last_->next_ : first_) = &slot;
+    last_ = &slot;
+}
+
+void Observable::unlink(Slot& slot)
+{
+    (slot.previous_ ? slot.previous_->next_ : first_) = slot.next_;
+    (slot.next_ ? slot.next_->previous_ : last_) = slot.previous_;
+    slot.observable_ = nullptr;
+    slot.previous_ = nullptr;
+    slot.next_ = nullptr;
+}
+
+void Observable::disconnect_all()
+{
+    while (first_)
+    {
+        unlink(*first_);
+    }
+}
+
+void Observable::begin_transaction()
+{
+    ++transaction_depth_;
+}
+
+// Exception:
+//  - Precondition: a transaction must have been started.
+void Observable::commit_transaction()
+{
+    Expects(transaction_depth_ > 0);
+    if (--transaction_depth_ > 0 || !notification_deferred_)
+    {
+        return;
+    }
+    notification_deferred_ = false;
+    on_commit();
+    notify();
+}
+
+Observable::Transaction::Transaction(Observable& observable)
+    : observable_ {observable}
+{
+    observable_.begin_transaction();
+}
+
+Observable::Transaction::~Transaction()
+{
+    observable_.commit_transaction();
+}
+
+void Observable::notify()
+{
+    if (transaction_depth_ > 0)
+    {
+        notification_deferred_ = true;
+        return;
+    }
+    // The next slot is read before the call: a callback can disconnect its
+    // own slot.
+    for (Slot* slot = first_; slot; )
     {
-        p.second();
+        Slot* next = slot->next_;
+        slot->callback_();
+        slot = next;
     }
 }
+
+bool Observable::in_transaction() const
+{
+    return transaction_depth_ > 0;
+}
+
+bool Observable::is_notification_deferred() const
+{
+    return notification_deferred_;
+}
+
+void Observable::on_commit()
+{
+}
@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <gsl/gsl>
+#include "Production.h"
+
+namespace
+{
+    // 'left + right', saturated at 'Production::SATURATED'.
+    std::uint64_t saturated_add(std::uint64_t left, std::uint64_t right)
+    {
+        return left > Production::SATURATED - right ? Production::SATURATED : left + right;
+    }
+}
+
+// Exception:
+//  - Precondition: 'max_n' must be positive.
+Production::Production(const LSystem& lsys, int max_n)
+    : max_n_ {max_n}
+{
+    Expects(max_n >= 0);
+
+    const auto& rules = lsys.get_rules();
+    auto axiom = lsys.get_axiom();
+    auto predecessors = lsys.get_iteration_predecessors();
+
+    // Index the root, then every symbol of the axiom and of the rules.
+    index_.fill(-1);
+    symbols_.push_back('\0');
+    auto add_symbol = [this](char c)
+        {
+            auto& index = index_[static_cast<unsigned char>(c)];
+            if (index < 0)
+            {
+                index = gsl::narrow<int>(symbols_.size());
+                symbols_.push_back(c);
+            }
+            return index;
+        };
+    for (char c : axiom)
+    {
+        add_symbol(c);
+    }
+    for (const auto& [predecessor, successor] : rules)
+    {
+        add_symbol(predecessor);
+        for (char c : successor)
+        {
+            add_symbol(c);
+        }
+    }
+
+    // The successors of the symbols.
+    auto n_symbols = symbols_.size();
+    has_rule_.assign(n_symbols, false);
+    is_counted_.assign(n_symbols, false);
+    for (std::size_t s = 0; s < n_symbols; ++s)
+    {
+        first_child_.push_back(children_.size());
+        const std::string* successor = nullptr;
+        if (s == 0)
+        {
+            successor = &axiom;
+        }
+        else if (auto it = rules.find(symbols_[s]); it != rules.end())
+        {
+            successor = &it->second;
+        }
+        if (successor)
+        {
+            has_rule_[s] = true;
+            for (char c : *successor)
+            {
+                children_.push_back(index_[static_cast<unsigned char>(c)]);
+            }
+        }
+        is_counted_[s] = s > 0 && predecessors.find(symbols_[s]) != std::string::npos;
+    }
+    first_child_.push_back(children_.size());
+
+    // The lengths and the prefix sums, generation by generation: a symbol
+    // derived 'g' times is the concatenation of its successor derived 'g-1'
+    // times.
+    auto n_generations = gsl::narrow<std::size_t>(max_n_) + 2;
+    lengths_.assign(n_symbols * n_generations, 1);
+    for (std::size_t s = 0; s < n_symbols; ++s)
+    {
+        first_prefix_.push_back(prefixes_.size());
+        if (has_rule_[s])
+        {
+            auto k = first_child_[s+1] - first_child_[s];
+            prefixes_.resize(prefixes_.size() + (n_generations - 1) * (k + 1));
+        }
+    }
+    for (std::size_t g = 1; g < n_generations; ++g)
+    {
+        for (std::size_t s = 0; s < n_symbols; ++s)
+        {
+            if (!has_rule_[s])
+            {
+                continue;
+            }
+            auto k = first_child_[s+1] - first_child_[s];
+            auto* prefix = &prefixes_[first_prefix_[s] + (g - 1) * (k + 1)];
+            prefix[0] = 0;
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                auto child = children_[first_child_[s] + j];
+                prefix[j+1] = saturated_add(prefix[j], lengths_[child * n_generations + g - 1]);
+            }
+            lengths_[s * n_generations + g] = prefix[k];
+        }
+    }
+}
+
+int Production::get_max_iteration() const
+{
+    return max_n_;
+}
+
+// Exception:
+//  - Precondition: 'n' must be in [0, max_n].
+std::uint64_t Production::size(int n) const
+{
+    Expects(n >= 0 && n <= max_n_);
+    return length(0, n + 1);
+}
+
+char Production::symbol_at(int n, std::uint64_t i) const
+{
+    return symbols_[locate(n, i).first];
+}
+
+int Production::iteration_at(int n, std::uint64_t i) const
+{
+    return locate(n, i).second;
+}
+
+Production::Cursor Production::cursor(int n, std::uint64_t offset) const
+{
+    return Cursor(*this, n, offset);
+}
+
+// Exception:
+//  - Precondition: 'n' must be in [0, max_n] and 'size(n)' must not be
+//  saturated.
+//  - Precondition: 'chunks' must be strictly positive.
+std::vector<std::uint64_t> Production::split(int n, std::size_t chunks) const
+{
+    Expects(chunks > 0);
+    auto total = size(n);
+    Expects(total != SATURATED);
+
+    // 'total * k / chunks' without overflow.
+    auto quotient = total / chunks;
+    auto remainder = total % chunks;
+    std::vector<std::uint64_t> bounds;
+    bounds.reserve(chunks + 1);
+    for (std::size_t k = 0; k <= chunks; ++k)
+    {
+        bounds.push_back(quotient * k + remainder * k / chunks);
+    }
+    return bounds;
+}
+
+std::uint64_t Production::length(int symbol, int generation) const
+{
+    return lengths_[symbol * (max_n_ + 2) + generation];
+}
+
+const std::uint64_t* Production::prefixes(int symbol, int generation) const
+{
+    auto k = first_child_[symbol+1] - first_child_[symbol];
+    return &prefixes_[first_prefix_[symbol] + (generation - 1) * (k + 1)];
+}
+
+std::size_t Production::find_child(int symbol, int generation, std::uint64_t& i) const
+{
+    auto k = first_child_[symbol+1] - first_child_[symbol];
+    const auto* prefix = prefixes(symbol, generation);
+
+    // The last successor starting before 'i': the empty successors are
+    // skipped as they start where the next one starts.
+    auto child = gsl::narrow_cast<std::size_t>(std::upper_bound(prefix, prefix + k + 1, i) - prefix) - 1;
+    i -= prefix[child];
+    return child;
+}
+
+// Exception:
+//  - Precondition: 'n' must be in [0, max_n].
+//  - Precondition: 'i' must be lesser than 'size(n)', which must not be
+//  saturated.
+std::pair<int, int> Production::locate(int n, std::uint64_t i) const
+{
+    auto total = size(n);
+    Expects(total != SATURATED && i < total);
+
+    int symbol = 0;
+    int generation = n + 1;
+    int iteration = 0;
+    while (generation > 0 && has_rule_[symbol])
+    {
+        auto child = find_child(symbol, generation, i);
+        iteration += is_counted_[symbol] ? 1 : 0;
+        symbol = children_[first_child_[symbol] + child];
+        --generation;
+    }
+
+    // A terminal is derived into itself.
+    iteration += is_counted_[symbol] ? generation : 0;
+    return {symbol, iteration};
+}
+
+
+// Exception:
+//  - Precondition: 'n' must be in [0, max_n].
+//  - Precondition: 'offset' must be lesser or equal than 'size(n)', which
+//  must not be saturated.
+Production::Cursor::Cursor(const Production& production, int n, std::uint64_t offset)
+    : production_ {&production}
+    , position_ {offset}
+    , size_ {production.size(n)}
+{
+    Expects(size_ != SATURATED && offset <= size_);
+    if (offset == size_)
+    {
+        return;
+    }
+
+    // Same descent as 'locate()', keeping the path.
+    int symbol = 0;
+    int generation = n + 1;
+    int iteration = 0;
+    while (generation > 0 && production.has_rule_[symbol])
+    {
+        auto child = production.find_child(symbol, generation, offset);
+        path_.push_back({symbol, generation, child, iteration});
+        iteration += production.is_counted_[symbol] ? 1 : 0;
+        symbol = production.children_[production.first_child_[symbol] + child];
+        --generation;
+    }
+    symbol_ = symbol;
+    iteration_ = iteration + (production.is_counted_[symbol] ? generation : 0);
+}
+
+bool Production::Cursor::is_done() const
+{
+    return position_ == size_;
+}
+
+// Exception:
+//  - Precondition: the Cursor must not be done.
+char Production::Cursor::symbol() const
+{
+    Expects(!is_done());
+    return production_->symbols_[symbol_];
+}
+
+// Exception:
+//  - Precondition: the Cursor must not be done.
+int Production::Cursor::iteration() const
+{
+    Expects(!is_done());
+    return iteration_;
+}
+
+std::uint64_t Production::Cursor::position() const
+{
+    return position_;
+}
+
+// Exception:
+//  - Precondition: the Cursor must not be done.
+void Production::Cursor::next()
+{
+    Expects(!is_done());
+    ++position_;
+
+    // Go up to the first ancestor with a next non-empty successor, then down
+    // to its first symbol.
+    const auto& production = *production_;
+    while (!path_.empty())
+    {
+        auto& frame = path_.back();
+        auto first = production.first_child_[frame.symbol];
+        auto k = production.first_child_[frame.symbol+1] - first;
+        while (++frame.child < k)
+        {
+            int child = production.children_[first + frame.child];
+            if (production.length(child, frame.generation - 1) > 0)
+            {
+                int iteration = frame.iteration + (production.is_counted_[frame.symbol] ? 1 : 0);
+                descend(child, frame.generation - 1, iteration);
+                return;
+            }
+        }
+        path_.pop_back();
+    }
+    Ensures(is_done());
+}
+
+void Production::Cursor::descend(int symbol, int generation, int iteration)
+{
+    const auto& production = *production_;
+    while (generation > 0 && production.has_rule_[symbol])
+    {
+        // The length of 'symbol' is not null: it has a non-empty successor.
+        auto first = production.first_child_[symbol];
+        std::size_t child = 0;
+        while (production.length(production.children_[first + child], generation - 1) == 0)
+        {
+            ++child;
+        }
+        path_.push_back({symbol, generation, child, iteration});
+        iteration += production.is_counted_[symbol] ? 1 : 0;
+        symbol = production.children_[first + child];
+        --generation;
+    }
+    symbol_ = symbol;
+    iteration_ = iteration + (production.is_counted_[symbol] ? generation : 0);
+}
@@ -0,0 +1,185 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#if defined(PROFILER_COUNT_ALLOCATIONS)
+#include <malloc.h>
+#endif
+#include "Profiler.h"
+
+namespace
+{
+    // Allocation counters, updated by the replaced global 'operator new' and
+    // 'operator delete'. Only atomics and trivial thread-locals are used: the
+    // allocation functions must not allocate.
+    std::atomic<std::size_t> live_bytes_ {0};
+    std::atomic<std::size_t> peak_bytes_ {0};
+    thread_local std::size_t thread_allocated_bytes_ {0};
+
+    thread_local int current_context_ {Profiler::NO_CONTEXT};
+}
+
+#if defined(PROFILER_COUNT_ALLOCATIONS)
+// The size of a block is the usable size of its allocation by 'malloc()', so
+// it is known at deallocation without any header.
+//
+// The deallocation functions are not inlined: the compiler would otherwise
+// see the 'free()' of the blocks of the containers of this file allocated by
+// 'operator new' and warn of a mismatch.
+void* operator new(std::size_t size)
+{
+    void* block = std::malloc(size);
+    if (!block)
+    {
+        throw std::bad_alloc();
+    }
+    size = malloc_usable_size(block);
+
+    thread_allocated_bytes_ += size;
+    std::size_t live = live_bytes_ += size;
+    std::size_t peak = peak_bytes_.load();
+    while (live > peak && !peak_bytes_.compare_exchange_weak(peak, live))
+    {
+    }
+    return block;
+}
+
+[[gnu::noinline]] void operator delete(void* pointer) noexcept
+{
+    live_bytes_ -= malloc_usable_size(pointer);
+    std::free(pointer);
+}
+
+[[gnu::noinline]] void operator delete(void* pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+#endif
+
+
+const std::chrono::steady_clock::time_point Profiler::origin_ {std::chrono::steady_clock::now()};
+std::mutex Profiler::mutex_ {};
+std::deque<Profiler::Sample> Profiler::samples_ {};
+std::map<std::pair<int, std::string_view>, Profiler::Sample> Profiler::latest_ {};
+int Profiler::n_threads_ {0};
+
+Profiler::Scope::Scope(const char* name, unsigned long items)
+    : name_ {name}
+    , items_ {items}
+    , start_ {std::chrono::steady_clock::now()}
+    , allocated_at_start_ {thread_allocated_bytes()}
+{
+}
+
+Profiler::Scope::~Scope()
+{
+    using namespace std::chrono;
+    auto end = steady_clock::now();
+    record({name_,
+            current_context_,
+            duration_cast<microseconds>(start_ - origin_),
+            duration_cast<microseconds>(end - start_),
+            items_,
+            thread_allocated_bytes() - allocated_at_start_,
+            thread_index()});
+}
+
+void Profiler::Scope::set_items(unsigned long items)
+{
+    items_ = items;
+}
+
+Profiler::Context::Context(int context)
+    : previous_ {current_context_}
+{
+    current_context_ = context;
+}
+
+Profiler::Context::~Context()
+{
+    current_context_ = previous_;
+}
+
+std::optional<Profiler::Sample> Profiler::latest(int context, std::string_view name)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto it = latest_.find({context, name});
+    if (it == end(latest_))
+    {
+        return {};
+    }
+    return it->second;
+}
+
+void Profiler::export_chrome_trace(std::ostream& os)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    // Complete events ("ph": "X"), one per sample. The names are string
+    // literals of the code: they do not need to be escaped.
+    os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    bool first = true;
+    for (const auto& sample : samples_)
+    {
+        os << (first ? "\n" : ",\n");
+        first = false;
+        os << "{\"name\": \"" << sample.name << "\", "
+           << "\"cat\": \"procgen\", \"ph\": \"X\", "
+           << "\"ts\": " << sample.start.count() << ", "
+           << "\"dur\": " << sample.duration.count() << ", "
+           << "\"pid\": 0, \"tid\": " << sample.thread << ", "
+           << "\"args\": {\"context\": " << sample.context << ", "
+           << "\"items\": " << sample.items << ", "
+           << "\"allocated_bytes\": " << sample.allocated_bytes << "}}";
+    }
+    os << "\n]}\n";
+}
+
+void Profiler::clear()
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    samples_.clear();
+    latest_.clear();
+}
+
+std::size_t Profiler::thread_allocated_bytes()
+{
+    return thread_allocated_bytes_;
+}
+
+std::size_t Profiler::live_bytes()
+{
+    return live_bytes_.load();
+}
+
+std::size_t Profiler::peak_bytes()
+{
+    return peak_bytes_.load();
+}
+
+void Profiler::reset_peak_bytes()
+{
+    peak_bytes_ = live_bytes_.load();
+}
+
+void Profiler::record(const Sample& sample)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (samples_.size() == MAX_SAMPLES)
+    {
+        samples_.pop_front();
+    }
+    samples_.push_back(sample);
+    latest_.insert_or_assign({sample.context, sample.name}, sample);
+}
+
+int Profiler::thread_index()
+{
+    // Attributed at the first sample of the thread.
+    thread_local int index {-1};
+    if (index < 0)
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        index = n_threads_++;
+    }
+    return index;
+}
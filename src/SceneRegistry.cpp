@@ -0,0 +1,127 @@
+#include <gsl/gsl>
+#include "SceneRegistry.h"
+
+namespace procgui
+{
+    SceneRegistry::Handle::operator bool() const
+    {
+        return index != INVALID;
+    }
+
+    bool SceneRegistry::Handle::operator==(const Handle& other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+
+    bool SceneRegistry::Handle::operator!=(const Handle& other) const
+    {
+        return !(*this == other);
+    }
+
+    SceneRegistry::Handle SceneRegistry::insert(LSystemView&& view)
+    {
+        // Reuse a free slot if possible.
+        std::uint32_t index = free_slot_;
+        if (index != INVALID)
+        {
+            free_slot_ = slots_[index].position;
+        }
+        else
+        {
+            index = gsl::narrow<std::uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+
+        slots_[index].position = gsl::narrow<std::uint32_t>(views_.size());
+        views_.push_back(std::move(view));
+        slot_of_.push_back(index);
+        return {index, slots_[index].generation};
+    }
+
+    // Exception:
+    //  - Precondition: 'handle' must refer to a view of the registry.
+    void SceneRegistry::erase(Handle handle)
+    {
+        Expects(contains(handle));
+
+        // Move the last view into the place of the erased one.
+        auto& slot = slots_[handle.index];
+        auto position = slot.position;
+        auto last = views_.size() - 1;
+        if (position != last)
+        {
+            views_[position] = std::move(views_[last]);
+            slot_of_[position] = slot_of_[last];
+            slots_[slot_of_[position]].position = position;
+        }
+        views_.pop_back();
+        slot_of_.pop_back();
+
+        // Free the slot: the handles referring to it are now stale.
+        ++slot.generation;
+        slot.position = free_slot_;
+        free_slot_ = handle.index;
+    }
+
+    bool SceneRegistry::contains(Handle handle) const
+    {
+        return handle.index < slots_.size() &&
+            slots_[handle.index].generation == handle.generation &&
+            slots_[handle.index].position < views_.size() &&
+            slot_of_[slots_[handle.index].position] == handle.index;
+    }
+
+    LSystemView* SceneRegistry::get(Handle handle)
+    {
+        return contains(handle) ? &views_[slots_[handle.index].position] : nullptr;
+    }
+
+    const LSystemView* SceneRegistry::get(Handle handle) const
+    {
+        return contains(handle) ? &views_[slots_[handle.index].position] : nullptr;
+    }
+
+    // Exception:
+    //  - Precondition: 'position' must be lesser than 'size()'.
+    SceneRegistry::Handle SceneRegistry::handle_at(std::size_t position) const
+    {
+        Expects(position < views_.size());
+        auto index = slot_of_[position];
+        return {index, slots_[index].generation};
+    }
+
+    const std::vector<LSystemView>& SceneRegistry::views() const
+    {
+        return views_;
+    }
+
+    std::size_t SceneRegistry::size() const
+    {
+        return views_.size();
+    }
+
+    bool SceneRegistry::empty() const
+    {
+        return views_.empty();
+    }
+
+    SceneRegistry::iterator SceneRegistry::begin()
+    {
+        return views_.begin();
+    }
+
+    SceneRegistry::iterator SceneRegistry::end()
+    {
+        return views_.end();
+    }
+
+    SceneRegistry::const_iterator SceneRegistry::begin() const
+    {
+        return views_.begin();
+    }
+
+    SceneRegistry::const_iterator SceneRegistry::end() const
+    {
+        return views_.end();
+    }
+}
@@ -1,8 +1,687 @@
+#include <array>
+#include <bitset>
+#include <complex>
+#include <optional>
 #include "Turtle.h"
 
 namespace drawing
 {
     using namespace impl;
+
+    namespace
+    {
+        // Number of symbols interpreted between two checks of the
+        // cancellation flag and two calls of the partial result function.
+        constexpr unsigned check_period = 4096;
+
+        // The drawing of the complete expansion of a symbol, for a Turtle
+        // starting at the origin in the direction (1, 0). The vectors are
+        // complex numbers in the mathematical frame (y-axis upward): a
+        // Turtle starting at 'position' in the direction 'direction' ends at
+        // 'position + direction * displacement' in the direction
+        // 'direction * rotation'.
+        struct Expansion
+        {
+            std::complex<double> displacement {0, 0};
+            std::complex<double> rotation {1, 0};
+            // The radius of a disk centered on the starting position
+            // containing the whole drawing.
+            double radius {0};
+            // True if at least one segment is drawn.
+            bool draws {false};
+            // True if the expansion loads as many positions as it saves:
+            // only then can it be replaced by a single segment.
+            bool balanced {true};
+            // The greatest increment of the iteration count in the
+            // expansion.
+            int max_increment {0};
+            // The number of segments drawn and of positions loaded, the
+            // change of the number of saved positions and its lowest and
+            // highest values during the expansion. The loads are counted as
+            // if the stack was never empty.
+            std::uint64_t segments {0};
+            std::uint64_t loads {0};
+            std::int64_t depth_change {0};
+            std::int64_t min_depth {0};
+            std::int64_t max_depth {0};
+        };
+
+        // The vertices drawn by the complete expansion of a symbol, in the
+        // frame of the Turtle at its start (the position is the origin and
+        // the direction is (1, 0) in the mathematical frame), and their
+        // iteration counts relative to the iteration count of the symbol.
+        struct Record
+        {
+            std::vector<sf::Vertex> vertices {};
+            std::vector<int> iterations {};
+        };
+
+        // The maximum number of vertices of a record and of all the records
+        // of an interpretation. A larger expansion is instanced from the
+        // records of its successor: the records stay small enough to be
+        // copied from the cache.
+        constexpr std::size_t max_record_vertices = 1 << 14;
+        constexpr std::size_t max_recorded_vertices = 1 << 20;
+
+        // The maximum number of vertices allocated in advance.
+        constexpr std::uint64_t max_reserved_vertices = 1 << 28;
+
+        // The depth-first expansion of the LSystem for 'compute_vertices()'
+        // and 'compute_vertices_adaptive()'.
+        class DepthFirstInterpreter
+        {
+        public:
+            DepthFirstInterpreter(const LSystem& lsys,
+                                const InterpretationMap& interpretation,
+                                const DrawingParameters& parameters,
+                                double min_extent,
+                                const std::optional<sf::FloatRect>& region,
+                                const std::atomic<bool>* cancelled,
+                                const partial_fn& partial)
+                : parameters_ {parameters}
+                , n_iter_ {parameters.get_n_iter()}
+                , min_extent_ {min_extent}
+                , region_ {region}
+                , cancelled_ {cancelled}
+                , partial_ {partial}
+                , turtle_ {parameters, {0}}
+                , expansions_ (256 * (n_iter_ + 1))
+                , records_ (256 * (n_iter_ + 1))
+                {
+                    // Direct access to the rules and orders: the maps are
+                    // searched once for each symbol of the vocabulary.
+                    for (const auto& [predecessor, successor] : lsys.get_rules())
+                    {
+                        successors_[index(predecessor)] = &successor;
+                    }
+                    for (const auto& [symbol, order] : interpretation.get_rules())
+                    {
+                        orders_[index(symbol)] = &order;
+                    }
+                    for (auto c : lsys.get_iteration_predecessors())
+                    {
+                        is_counted_[index(c)] = true;
+                    }
+                    max_iteration_ = max_iteration(lsys.get_axiom());
+                }
+
+            std::tuple<std::vector<sf::Vertex>, std::vector<int>, int> interpret(const std::string& axiom)
+                {
+                    // The exact number of vertices is predicted: the buffers
+                    // are allocated once.
+                    if (min_extent_ == 0 && !region_)
+                    {
+                        auto n_vertices = predict(axiom, false).vertices;
+                        if (n_vertices <= max_reserved_vertices)
+                        {
+                            turtle_.vertices.reserve(n_vertices);
+                            turtle_.iteration_of_vertices.reserve(n_vertices);
+                        }
+                    }
+
+                    for (auto c : axiom)
+                    {
+                        if (!interpret(c, n_iter_, 0))
+                        {
+                            break;
+                        }
+                    }
+                    Ensures(turtle_.vertices.size() == turtle_.iteration_of_vertices.size());
+                    return {std::move(turtle_.vertices), std::move(turtle_.iteration_of_vertices), max_iteration_};
+                }
+
+            // Predict the statistics of the interpretation of 'axiom',
+            // without its bounding box if 'with_box' is false.
+            //
+            // The interpretation is simulated without vertices. Once the
+            // drawing is started, the counts of a balanced expansion are
+            // the counts of its memoized expansion, and its simulation is
+            // skipped if it can not enlarge the bounding box: its disk is
+            // inside of it.
+            Statistics predict(const std::string& axiom, bool with_box)
+                {
+                    with_box_ = with_box;
+                    prediction_ = {};
+                    predicted_state_ = turtle_.state;
+                    predicted_stack_.clear();
+                    is_started_ = false;
+                    for (auto c : axiom)
+                    {
+                        if (!predict(c, n_iter_))
+                        {
+                            break;
+                        }
+                    }
+                    prediction_.length = prediction_.segments * parameters_.get_step();
+                    if (with_box_ && is_started_)
+                    {
+                        prediction_.bounding_box = {static_cast<float>(min_.x),
+                                                    static_cast<float>(min_.y),
+                                                    static_cast<float>(max_.x - min_.x),
+                                                    static_cast<float>(max_.y - min_.y)};
+                    }
+                    return prediction_;
+                }
+
+        private:
+            // Add 'position' to the predicted bounding box.
+            void enlarge(const sf::Vector2<double>& position)
+                {
+                    min_ = {std::min(min_.x, position.x), std::min(min_.y, position.y)};
+                    max_ = {std::max(max_.x, position.x), std::max(max_.y, position.y)};
+                }
+
+            // Simulate 'order' on the predicted state, as the orders of
+            // 'InterpretationMap.h' on a Turtle.
+            void predict(const Order& order)
+                {
+                    auto& state = predicted_state_;
+                    const auto& d = state.direction;
+                    switch (order.id)
+                    {
+                    case OrderID::GO_FORWARD:
+                        if (!is_started_)
+                        {
+                            is_started_ = true;
+                            min_ = max_ = state.position;
+                        }
+                        state.position += {parameters_.get_step() * d.x, parameters_.get_step() * -d.y};
+                        enlarge(state.position);
+                        prediction_.segments += 1;
+                        prediction_.vertices += 2;
+                        break;
+                    case OrderID::TURN_RIGHT:
+                        state.direction = {d.x * turtle_.cos - d.y * turtle_.sin,
+                                           d.x * turtle_.sin + d.y * turtle_.cos};
+                        break;
+                    case OrderID::TURN_LEFT:
+                        state.direction = {d.x * turtle_.cos + d.y * turtle_.sin,
+                                           -d.x * turtle_.sin + d.y * turtle_.cos};
+                        break;
+                    case OrderID::SAVE_POSITION:
+                        predicted_stack_.push_back(state);
+                        prediction_.max_depth = std::max<std::uint64_t>(prediction_.max_depth,
+                                                                        predicted_stack_.size());
+                        break;
+                    case OrderID::LOAD_POSITION:
+                        // Ignored until the drawing is started.
+                        if (!predicted_stack_.empty() && is_started_)
+                        {
+                            state = predicted_stack_.back();
+                            predicted_stack_.pop_back();
+                            prediction_.vertices += 2;
+                        }
+                        break;
+                    }
+                }
+
+            // Predict the statistics of 'c' with 'depth' remaining
+            // iterations. Returns false if the computation is cancelled.
+            bool predict(char c, int depth)
+                {
+                    if (!is_expanded(c, depth))
+                    {
+                        if (++predicted_ % check_period == 0 && cancelled_ && *cancelled_)
+                        {
+                            return false;
+                        }
+                        if (const auto* order = orders_[index(c)])
+                        {
+                            predict(*order);
+                        }
+                        return true;
+                    }
+
+                    const auto& e = expansion(c, depth);
+                    auto& state = predicted_state_;
+                    if (is_started_ && e.balanced &&
+                        (!with_box_ || (state.position.x - e.radius >= min_.x &&
+                                        state.position.y - e.radius >= min_.y &&
+                                        state.position.x + e.radius <= max_.x &&
+                                        state.position.y + e.radius <= max_.y)))
+                    {
+                        prediction_.segments += e.segments;
+                        prediction_.vertices += 2 * (e.segments + e.loads);
+                        prediction_.max_depth = std::max<std::uint64_t>(prediction_.max_depth,
+                                                                        predicted_stack_.size() + e.max_depth);
+                        std::complex<double> direction {state.direction.x, state.direction.y};
+                        auto displacement = direction * e.displacement;
+                        state.position += {displacement.real(), -displacement.imag()};
+                        direction *= e.rotation;
+                        state.direction = {direction.real(), direction.imag()};
+                        return true;
+                    }
+
+                    for (auto s : *successors_[index(c)])
+                    {
+                        if (!predict(s, depth - 1))
+                        {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+
+            static std::size_t index(char c)
+                {
+                    return static_cast<unsigned char>(c);
+                }
+
+            // True if 'c' is replaced by its successor at the 'depth'-th
+            // iteration before the last one: otherwise it is interpreted.
+            bool is_expanded(char c, int depth) const
+                {
+                    return depth > 0 && successors_[index(c)];
+                }
+
+            // The maximum iteration count, as returned by 'LSystem::produce()':
+            // the number of derivations where a symbol of the iteration
+            // predecessors is replaced. Only the set of the symbols of each
+            // iteration is computed.
+            int max_iteration(const std::string& axiom) const
+                {
+                    std::bitset<256> symbols;
+                    for (auto c : axiom)
+                    {
+                        symbols.set(index(c));
+                    }
+                    int max = 0;
+                    for (int i = 0; i < n_iter_; ++i)
+                    {
+                        std::bitset<256> next;
+                        bool new_iteration = false;
+                        for (std::size_t c = 0; c < symbols.size(); ++c)
+                        {
+                            if (!symbols.test(c))
+                            {
+                                continue;
+                            }
+                            new_iteration = new_iteration || is_counted_[c];
+                            if (successors_[c])
+                            {
+                                for (auto s : *successors_[c])
+                                {
+                                    next.set(index(s));
+                                }
+                            }
+                            else
+                            {
+                                next.set(c);
+                            }
+                        }
+                        max += new_iteration ? 1 : 0;
+                        symbols = next;
+                    }
+                    return max;
+                }
+
+            // The expansion of 'c' for 'depth' remaining iterations, computed
+            // once from the expansions of its successor.
+            const Expansion& expansion(char c, int depth)
+                {
+                    auto& cached = expansions_[index(c) * (n_iter_ + 1) + depth];
+                    if (cached)
+                    {
+                        return *cached;
+                    }
+
+                    Expansion result;
+                    if (!is_expanded(c, depth))
+                    {
+                        // Interpreted after 'depth' identity derivations.
+                        result.max_increment = is_counted_[index(c)] ? depth : 0;
+                        if (const auto* order = orders_[index(c)])
+                        {
+                            double delta = parameters_.get_delta_angle();
+                            switch (order->id)
+                            {
+                            case OrderID::GO_FORWARD:
+                                result.displacement = parameters_.get_step();
+                                result.radius = parameters_.get_step();
+                                result.draws = true;
+                                result.segments = 1;
+                                break;
+                            case OrderID::TURN_RIGHT:
+                                result.rotation = {std::cos(delta), std::sin(delta)};
+                                break;
+                            case OrderID::TURN_LEFT:
+                                result.rotation = {std::cos(delta), -std::sin(delta)};
+                                break;
+                            case OrderID::SAVE_POSITION:
+                                result.balanced = false;
+                                result.depth_change = 1;
+                                result.max_depth = 1;
+                                break;
+                            case OrderID::LOAD_POSITION:
+                                result.balanced = false;
+                                result.loads = 1;
+                                result.depth_change = -1;
+                                result.min_depth = -1;
+                                break;
+                            }
+                        }
+                    }
+                    else
+                    {
+                        // Concatenation of the expansions of the successor.
+                        // The saved positions are relative to the start of
+                        // 'c'.
+                        std::vector<std::pair<std::complex<double>, std::complex<double>>> stack;
+                        int increment = is_counted_[index(c)] ? 1 : 0;
+                        for (auto s : *successors_[index(c)])
+                        {
+                            const auto& child = expansion(s, depth - 1);
+                            result.segments += child.segments;
+                            result.loads += child.loads;
+                            result.min_depth = std::min(result.min_depth, result.depth_change + child.min_depth);
+                            result.max_depth = std::max(result.max_depth, result.depth_change + child.max_depth);
+                            result.depth_change += child.depth_change;
+
+                            const auto* order = orders_[index(s)];
+                            if (!is_expanded(s, depth - 1) && order &&
+                                order->id == OrderID::SAVE_POSITION)
+                            {
+                                stack.push_back({result.displacement, result.rotation});
+                                continue;
+                            }
+                            if (!is_expanded(s, depth - 1) && order &&
+                                order->id == OrderID::LOAD_POSITION)
+                            {
+                                if (stack.empty())
+                                {
+                                    result.balanced = false;
+                                }
+                                else
+                                {
+                                    std::tie(result.displacement, result.rotation) = stack.back();
+                                    stack.pop_back();
+                                }
+                                continue;
+                            }
+
+                            result.radius = std::max(result.radius,
+                                                     std::abs(result.displacement) + child.radius);
+                            result.displacement += result.rotation * child.displacement;
+                            result.rotation *= child.rotation;
+                            result.draws = result.draws || child.draws;
+                            result.balanced = result.balanced && child.balanced;
+                            result.max_increment = std::max(result.max_increment,
+                                                            increment + child.max_increment);
+                        }
+                        result.balanced = result.balanced && stack.empty();
+                    }
+
+                    cached = result;
+                    return *cached;
+                }
+
+            // True if the disk of center 'center' and of radius 'radius' is
+            // inside 'region_'.
+            bool is_inside_region(const sf::Vector2<double>& center, double radius) const
+                {
+                    return !region_ ||
+                        (center.x - radius >= region_->left &&
+                         center.y - radius >= region_->top &&
+                         center.x + radius <= region_->left + region_->width &&
+                         center.y + radius <= region_->top + region_->height);
+                }
+
+            // True if the disk of center 'center' and of radius 'radius'
+            // intersects 'region_'.
+            bool is_in_region(const sf::Vector2<double>& center, double radius) const
+                {
+                    if (!region_)
+                    {
+                        return true;
+                    }
+                    double right = region_->left + region_->width;
+                    double bottom = region_->top + region_->height;
+                    double dx = std::max({region_->left - center.x, 0., center.x - right});
+                    double dy = std::max({region_->top - center.y, 0., center.y - bottom});
+                    return dx*dx + dy*dy <= radius*radius;
+                }
+
+            // Move the turtle to 'position' without drawing. As for a
+            // loaded position, the jump is hidden by two transparent
+            // vertices. Consecutive jumps only move the last one.
+            // Note: the first jump is also recorded, as 'load_position_fn()'
+            // does nothing while there is no vertex.
+            void jump(const sf::Vector2<double>& position, int iteration)
+                {
+                    auto& vertices = turtle_.vertices;
+                    if (vertices.size() == last_jump_ && !vertices.empty())
+                    {
+                        turtle_.state.position = position;
+                        vertices.back().position = sf::Vector2f(position);
+                        return;
+                    }
+                    auto from = vertices.empty() ? sf::Vector2f(turtle_.state.position) : vertices.back().position;
+                    turtle_.state.position = position;
+                    vertices.push_back({from, sf::Color::Transparent});
+                    vertices.push_back({sf::Vector2f(position), sf::Color::Transparent});
+                    turtle_.iteration_of_vertices.push_back(iteration);
+                    turtle_.iteration_of_vertices.push_back(iteration);
+                    last_jump_ = vertices.size();
+                }
+
+            // Count 'n' interpreted symbols or instanced vertices, and
+            // regularly check the cancellation flag and publish the partial
+            // result. Returns false if the computation is cancelled.
+            bool progress(unsigned long n)
+                {
+                    interpreted_ += n;
+                    if (interpreted_ < next_check_)
+                    {
+                        return true;
+                    }
+                    next_check_ = interpreted_ + check_period;
+                    if (cancelled_ && *cancelled_)
+                    {
+                        return false;
+                    }
+                    if (partial_)
+                    {
+                        partial_(turtle_.vertices, turtle_.iteration_of_vertices, max_iteration_);
+                    }
+                    return true;
+                }
+
+            // Save the vertices drawn since 'first' by the expansion started
+            // in the state 'start' with the iteration count 'iteration' as
+            // the record of 'key', if the budget allows it.
+            void record(std::size_t key, std::size_t first, const Turtle::State& start, int iteration)
+                {
+                    auto size = turtle_.vertices.size() - first;
+                    if (size > max_record_vertices || recorded_ + size > max_recorded_vertices)
+                    {
+                        return;
+                    }
+                    recorded_ += size;
+
+                    // Inverse of the transform of 'instance()': the local
+                    // position is 'conj(offset * direction)'.
+                    double x = start.direction.x;
+                    double y = start.direction.y;
+                    Record record;
+                    record.vertices.resize(size);
+                    record.iterations.resize(size);
+                    for (std::size_t i = 0; i < size; ++i)
+                    {
+                        const auto& vertex = turtle_.vertices[first + i];
+                        double dx = vertex.position.x - start.position.x;
+                        double dy = vertex.position.y - start.position.y;
+                        auto& local = record.vertices[i];
+                        local.position.x = static_cast<float>(dx * x - dy * y);
+                        local.position.y = static_cast<float>(-dx * y - dy * x);
+                        local.color = vertex.color;
+                        record.iterations[i] = turtle_.iteration_of_vertices[first + i] - iteration;
+                    }
+                    records_[key] = std::move(record);
+                }
+
+            // Draw 'record' in the current state of the turtle with the
+            // iteration count 'iteration', then apply 'e'.
+            void instance(const Record& record, const Expansion& e, int iteration)
+                {
+                    // The offset of a vertex is 'conj(direction * local)'.
+                    // Note: computed without std::complex, whose
+                    // multiplication checks the infinite values.
+                    auto& state = turtle_.state;
+                    double x = state.direction.x;
+                    double y = state.direction.y;
+                    auto& vertices = turtle_.vertices;
+                    auto& iterations = turtle_.iteration_of_vertices;
+                    auto first = vertices.size();
+                    vertices.resize(first + record.vertices.size());
+                    iterations.resize(first + record.iterations.size());
+                    for (std::size_t i = 0; i < record.vertices.size(); ++i)
+                    {
+                        const auto& local = record.vertices[i];
+                        auto& vertex = vertices[first + i];
+                        vertex.position.x = static_cast<float>(state.position.x + x * local.position.x - y * local.position.y);
+                        vertex.position.y = static_cast<float>(state.position.y - x * local.position.y - y * local.position.x);
+                        vertex.color = local.color;
+                        iterations[first + i] = iteration + record.iterations[i];
+                    }
+
+                    std::complex<double> direction {x, y};
+                    auto displacement = direction * e.displacement;
+                    state.position += {displacement.real(), -displacement.imag()};
+                    direction *= e.rotation;
+                    state.direction = {direction.real(), direction.imag()};
+                }
+
+            // Interpret 'c' with 'depth' remaining iterations and the
+            // iteration count 'iteration'. Returns false if the computation
+            // is cancelled.
+            bool interpret(char c, int depth, int iteration)
+                {
+                    if (!is_expanded(c, depth))
+                    {
+                        if (!progress(1))
+                        {
+                            return false;
+                        }
+                        if (const auto* order = orders_[index(c)])
+                        {
+                            turtle_.iteration_vec[0] = iteration + (is_counted_[index(c)] ? depth : 0);
+                            order->order(turtle_);
+                        }
+                        return true;
+                    }
+
+                    const auto& e = expansion(c, depth);
+                    if (e.balanced && !is_in_region(turtle_.state.position, e.radius))
+                    {
+                        // Invisible: only its effect on the turtle is
+                        // applied.
+                        auto& state = turtle_.state;
+                        std::complex<double> direction {state.direction.x, state.direction.y};
+                        auto displacement = direction * e.displacement;
+                        jump(state.position + sf::Vector2<double>(displacement.real(), -displacement.imag()),
+                             iteration);
+                        direction *= e.rotation;
+                        state.direction = {direction.real(), direction.imag()};
+                        return true;
+                    }
+                    if (e.balanced && e.radius < min_extent_)
+                    {
+                        // Too small: replaced by the segment between its
+                        // extremities.
+                        auto& state = turtle_.state;
+                        std::complex<double> direction {state.direction.x, state.direction.y};
+                        auto displacement = direction * e.displacement;
+                        if (e.draws)
+                        {
+                            int count = iteration + e.max_increment;
+                            turtle_.vertices.push_back(sf::Vector2f(state.position));
+                            state.position += {displacement.real(), -displacement.imag()};
+                            turtle_.vertices.push_back(sf::Vector2f(state.position));
+                            turtle_.iteration_of_vertices.push_back(count);
+                            turtle_.iteration_of_vertices.push_back(count);
+                        }
+                        else
+                        {
+                            state.position += {displacement.real(), -displacement.imag()};
+                        }
+                        direction *= e.rotation;
+                        state.direction = {direction.real(), direction.imag()};
+                        return true;
+                    }
+
+                    // A balanced expansion draws the same vertices up to the
+                    // transform of its starting state: it is interpreted once
+                    // and instanced afterwards. Not if the drawing is not
+                    // started yet, as the loaded positions are then ignored,
+                    // nor if a part of it could be outside of the region.
+                    auto key = index(c) * (n_iter_ + 1) + depth;
+                    bool is_instanced = e.balanced && !turtle_.vertices.empty() &&
+                        is_inside_region(turtle_.state.position, e.radius);
+                    if (is_instanced && records_[key])
+                    {
+                        instance(*records_[key], e, iteration);
+                        return progress(records_[key]->vertices.size());
+                    }
+
+                    auto first = turtle_.vertices.size();
+                    auto start = turtle_.state;
+                    int successor_iteration = iteration + (is_counted_[index(c)] ? 1 : 0);
+                    for (auto s : *successors_[index(c)])
+                    {
+                        if (!interpret(s, depth - 1, successor_iteration))
+                        {
+                            return false;
+                        }
+                    }
+                    if (is_instanced)
+                    {
+                        record(key, first, start, iteration);
+                    }
+                    return true;
+                }
+
+            const DrawingParameters& parameters_;
+            const int n_iter_;
+            const double min_extent_;
+            const std::optional<sf::FloatRect> region_;
+            const std::atomic<bool>* cancelled_;
+            const partial_fn& partial_;
+            Turtle turtle_;
+
+            // The successor, the order and the iteration predecessor flag of
+            // each symbol.
+            std::array<const std::string*, 256> successors_ {};
+            std::array<const Order*, 256> orders_ {};
+            std::array<bool, 256> is_counted_ {};
+
+            // The expansion of each symbol for each remaining number of
+            // iterations, indexed by 'symbol * (n_iter_ + 1) + depth'.
+            std::vector<std::optional<Expansion>> expansions_;
+
+            // The record of each symbol for each remaining number of
+            // iterations, with the same index, and their total number of
+            // vertices.
+            std::vector<std::optional<Record>> records_;
+            std::size_t recorded_ {0};
+
+            int max_iteration_ {0};
+            unsigned long interpreted_ {0};
+            unsigned long next_check_ {0};
+            // The number of vertices after the latest jump.
+            std::size_t last_jump_ {0};
+
+            // The state of the prediction: the statistics, the simulated
+            // turtle and the predicted bounding box.
+            Statistics prediction_ {};
+            bool with_box_ {false};
+            Turtle::State predicted_state_ {};
+            std::vector<Turtle::State> predicted_stack_ {};
+            bool is_started_ {false};
+            sf::Vector2<double> min_ {};
+            sf::Vector2<double> max_ {};
+            unsigned long predicted_ {0};
+        };
+    }
     
     Turtle::Turtle(const DrawingParameters& params,
                    const std::vector<int>& iteration_vec)
@@ -15,34 +694,39 @@ namespace drawing
     }
 
     std::tuple<std::vector<sf::Vertex>, std::vector<int>, int>
-        compute_vertices(LSystem& lsys,
-                         InterpretationMap& interpretation,
-                         const DrawingParameters& parameters)
+        compute_vertices(const LSystem& lsys,
+                         const InterpretationMap& interpretation,
+                         const DrawingParameters& parameters,
+                         const std::atomic<bool>* cancelled,
+                         const partial_fn& partial)
+    {
+        DepthFirstInterpreter interpreter (lsys, interpretation, parameters,
+                                           0, std::nullopt, cancelled, partial);
+        return interpreter.interpret(lsys.get_axiom());
+    }
 
+    std::tuple<std::vector<sf::Vertex>, std::vector<int>, int>
+        compute_vertices_adaptive(const LSystem& lsys,
+                                  const InterpretationMap& interpretation,
+                                  const DrawingParameters& parameters,
+                                  double min_extent,
+                                  const std::optional<sf::FloatRect>& region,
+                                  const std::atomic<bool>* cancelled,
+                                  const partial_fn& partial)
     {
-        const auto [str, rec, max] = lsys.produce(parameters.get_n_iter());
-        Turtle turtle (parameters, rec);
-        
-        for (auto c : str)
-        {
-            if (interpretation.has_predecessor(c))
-            {
-                // If an interpretation of the character 'c' is found,
-                // applies it to the current turtle.
-                interpretation.get_rule(c).second(turtle);
-            }
-            else
-            {
-                // Do nothing: if 'c' does not have an associated
-                // order, it has no effects.
-            }
-            // Increment the iteration index: each character has an iteration
-            // count. Can not be in the orders, otherwise characters without
-            // orders will not increment this index.
-            ++turtle.iteration_index;
-        }
-
-        Ensures(turtle.vertices.size() == turtle.iteration_of_vertices.size());
-        return {turtle.vertices, turtle.iteration_of_vertices, max};
+        DepthFirstInterpreter interpreter (lsys, interpretation, parameters,
+                                           min_extent, region, cancelled, partial);
+        return interpreter.interpret(lsys.get_axiom());
+    }
+
+    Statistics compute_statistics(const LSystem& lsys,
+                                  const InterpretationMap& interpretation,
+                                  const DrawingParameters& parameters,
+                                  bool with_bounding_box,
+                                  const std::atomic<bool>* cancelled)
+    {
+        DepthFirstInterpreter interpreter (lsys, interpretation, parameters,
+                                           0, std::nullopt, cancelled, nullptr);
+        return interpreter.predict(lsys.get_axiom(), with_bounding_box);
     }
 }
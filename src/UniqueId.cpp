@@ -1,37 +1,30 @@
 #include <gsl/gsl>
-#include <algorithm>
 #include "UniqueId.h"
 
 int UniqueId::get_id()
 {
-    //Search if there is a free slot in 'map_'.
-    auto free_slot = std::find_if(begin(map_), end(map_),
-                                   [](const auto& p)
-                                   {return std::get<IsFree>(p);});
-    if (free_slot != end(map_))
+    if (!free_ids_.empty())
     {
-        // There is, return the associated identifier
-        std::get<IsFree>(*free_slot) = false;
-        return std::get<Id>(*free_slot);
+        // There is a free identifier, reuse it.
+        int id = free_ids_.back();
+        free_ids_.pop_back();
+        is_free_[id] = false;
+        return id;
     }
     else
     {
-        // There is not, add a new id to 'map_' and return it.
-        map_.push_back({next_id_, false});
-        return next_id_++;
+        // There is not, generate a new one.
+        is_free_.push_back(false);
+        return gsl::narrow<int>(is_free_.size() - 1);
     }
 }
     
 void UniqueId::free_id(int id)
 {
-    // Assert precondition: 'id' must have been registered.
-    auto it = std::find_if(begin(map_), end(map_),
-                           [id](const auto& p)
-                           {return std::get<Id>(p) == id &&
-                            !std::get<IsFree>(p);});
-    Expects(it != end(map_));
+    // Assert precondition: 'id' must be used.
+    Expects(id >= 0 && static_cast<std::size_t>(id) < is_free_.size() && !is_free_[id]);
 
     // Mark the id as available.
-    std::get<IsFree>(*it) = true;;
+    is_free_[id] = true;
+    free_ids_.push_back(id);
 }
-
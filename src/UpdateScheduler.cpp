@@ -0,0 +1,76 @@
+#include <gsl/gsl>
+#include "UpdateScheduler.h"
+
+unsigned long UpdateScheduler::Counters::coalesced(Stage stage) const
+{
+    Expects(stage >= 0 && stage < StageCount);
+
+    // A stage can be executed more times than it was notified, as it is also
+    // executed when a previous stage is dirty.
+    auto notified = notifications.at(stage);
+    auto executed = executions.at(stage);
+    return notified > executed ? notified - executed : 0;
+}
+
+unsigned long UpdateScheduler::Counters::coalesced() const
+{
+    unsigned long total = 0;
+    for (int i=0; i<StageCount; ++i)
+    {
+        total += coalesced(Stage(i));
+    }
+    return total;
+}
+
+void UpdateScheduler::set_task(Stage stage, const std::function<void()>& task)
+{
+    Expects(stage >= 0 && stage < StageCount);
+    tasks_.at(stage) = task;
+}
+
+void UpdateScheduler::mark(Stage stage)
+{
+    Expects(stage >= 0 && stage < StageCount);
+    ++counters_.notifications.at(stage);
+    if (stage < first_dirty_)
+    {
+        first_dirty_ = stage;
+    }
+}
+
+bool UpdateScheduler::is_dirty() const
+{
+    return first_dirty_ < StageCount;
+}
+
+void UpdateScheduler::flush()
+{
+    if (!is_dirty())
+    {
+        return;
+    }
+
+    // Clean the stages first: the tasks may notify again.
+    int first = first_dirty_;
+    first_dirty_ = StageCount;
+    ++counters_.flushes;
+
+    for (int i=first; i<StageCount; ++i)
+    {
+        if (tasks_.at(i))
+        {
+            tasks_.at(i)();
+        }
+        ++counters_.executions.at(i);
+    }
+}
+
+void UpdateScheduler::clear()
+{
+    first_dirty_ = StageCount;
+}
+
+const UpdateScheduler::Counters& UpdateScheduler::get_counters() const
+{
+    return counters_;
+}
@@ -225,13 +225,12 @@ namespace colors
     }
 
     void VertexPainterComposite::paint_vertices(std::vector<sf::Vertex>& vertices,
-                                                const std::vector<int>& iteration_of_vertices,
+                                                gsl::span<const int> iteration_of_vertices,
                                                 int max_recursion,
                                                 sf::FloatRect bounding_box)
 
     {
         auto vertices_copy = vertices;
-        auto iteration_of_vertices_copy = iteration_of_vertices;
         
         // Prepare the variable for ColorGeneratorComposite
         color_distributor_->reset_index();
@@ -259,10 +258,10 @@ namespace colors
             std::vector<int> iteration_of_vertices_part;
             for(auto idx : v)
             {
-                // ... get each index and get from the '*_copy' the vertex and
-                // its iteration.
+                // ... get each index and get from 'vertices_copy' the vertex
+                // and from 'iteration_of_vertices' its iteration.
                 vertices_part.push_back(vertices_copy.at(idx));
-                iteration_of_vertices_part.push_back(iteration_of_vertices_copy.at(idx));
+                iteration_of_vertices_part.push_back(iteration_of_vertices.at(idx));
             }
             vertices_pools.push_back(vertices_part);
             iteration_of_vertices_pools.push_back(iteration_of_vertices_part);
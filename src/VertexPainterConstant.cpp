@@ -46,7 +46,7 @@ namespace colors
     }
     
     void VertexPainterConstant::paint_vertices(std::vector<sf::Vertex>& vertices,
-                                             const std::vector<int>&,
+                                             gsl::span<const int>,
                                              int,
                                              sf::FloatRect)
 
@@ -48,12 +48,12 @@ namespace colors
     }
     
     void VertexPainterIteration::paint_vertices(std::vector<sf::Vertex>& vertices,
-                                                const std::vector<int>& vertices_iteration,
+                                                gsl::span<const int> vertices_iteration,
                                                 int max_iteration,
                                                 sf::FloatRect)
 
     {
-        Expects(vertices.size() == vertices_iteration.size());
+        Expects(vertices.size() == static_cast<std::size_t>(vertices_iteration.size()));
         
         auto generator = get_target()->unwrap();
         if (!generator)
@@ -68,7 +68,7 @@ namespace colors
         }
 
 
-        for (auto i=0u; i<vertices_iteration.size(); ++i)
+        for (auto i=0u; i<vertices.size(); ++i)
         {
             sf::Color color = generator->get((vertices_iteration.at(i)-1) / (float(max_iteration)-1));
             sf::Vertex& v = vertices.at(i);
@@ -65,7 +65,7 @@ namespace colors
     }
 
     void VertexPainterLinear::paint_vertices(std::vector<sf::Vertex>& vertices,
-                                             const std::vector<int>&,
+                                             gsl::span<const int>,
                                              int,
                                              sf::FloatRect bounding_box)
     {
@@ -83,7 +83,7 @@ namespace colors
 
     
     void VertexPainterRandom::paint_vertices(std::vector<sf::Vertex>& vertices,
-                                             const std::vector<int>&,
+                                             gsl::span<const int>,
                                              int,
                                              sf::FloatRect)
 
@@ -5,8 +5,10 @@
 #include "cereal/archives/json.hpp"
 
 #include "helper_string.h"
+#include "DiskCache.h"
 #include "WindowController.h"
 #include "LSystemController.h"
+#include "Profiler.h"
 
 namespace fs = std::experimental::filesystem;
 
@@ -24,9 +26,13 @@ namespace controller
     bool WindowController::view_can_move_ {false};
 
     bool WindowController::save_menu_open_ {false};
+    bool WindowController::save_scene_ {false};
     bool WindowController::load_menu_open_ {false};
 
     fs::path WindowController::save_dir_ = fs::u8path(u8"saves");
+    std::unique_ptr<DirectoryIndex> WindowController::save_index_ {};
+
+    fs::path WindowController::trace_file_ = fs::u8path(u8"procgen_trace.json");
     
     sf::Vector2f WindowController::real_mouse_position(sf::Vector2i mouse_click)
     {
@@ -55,60 +61,73 @@ namespace controller
     }
 
 
-    void WindowController::paste_view(std::list<procgui::LSystemView>& lsys_views,
+    void WindowController::place_view(procgui::LSystemView& view, const sf::Vector2f& position)
+    {
+        // Update 'starting_position' so that the middle of the bounding box is
+        // at 'position'. The bounding box is predicted: the vertices are
+        // computed in the background.
+        auto box = view.get_predicted_bounding_box();
+        ext::sf::Vector2d pos {position};
+        ext::sf::Vector2d middle = {box.left + box.width/2, box.top + box.height/2};
+        middle = view.get_parameters().get_starting_position() - middle;
+        view.ref_parameters().set_starting_position(pos + middle);
+        view.prefetch();
+    }
+
+    void WindowController::paste_view(procgui::SceneRegistry& lsys_views,
                                       const std::optional<procgui::LSystemView>& view,
-                                      const sf::Vector2f& position,
-                                      bool is_loaded_from_disk)
+                                      const sf::Vector2f& position)
     {
         if (!view)
         {
             return;
         }
 
-        // Before adding the view to the vector<>, update
-        // 'starting_position' to the new location.
-        const auto& pasted_view = *view;
-        auto box = pasted_view.get_bounding_box();
-        ext::sf::Vector2d pos {position};
-        ext::sf::Vector2d middle = {box.left + box.width/2, box.top + box.height/2};
-        middle = pasted_view.get_parameters().get_starting_position() - middle;
-        if (!is_loaded_from_disk && LSystemController::is_clone())
-        {
-            auto cloned_view = pasted_view.clone();
-            cloned_view.ref_parameters().set_starting_position(pos + middle);
-            lsys_views.emplace_front(cloned_view);
-        }
-        else
-        {
-            auto duplicated_view = pasted_view.duplicate();
-            duplicated_view.ref_parameters().set_starting_position(pos + middle);
-            lsys_views.emplace_front(duplicated_view);
-        }
+        // Before adding the view to the list, update 'starting_position' to
+        // the new location.
+        auto pasted_view = LSystemController::is_clone() ? view->clone() : view->duplicate();
+        place_view(pasted_view, position);
+        lsys_views.insert(std::move(pasted_view));
     }
     
-    void WindowController::right_click_menu(sf::RenderWindow& window, std::list<procgui::LSystemView>& lsys_views)
+    void WindowController::right_click_menu(sf::RenderWindow& window, procgui::SceneRegistry& lsys_views)
     {
         if (ImGui::BeginPopupContextVoid())
         {
             if (ImGui::MenuItem("New LSystem", "Ctrl+N"))
             {
-                lsys_views.emplace_front(ext::sf::Vector2d(real_mouse_position(sf::Mouse::getPosition(window))));
+                lsys_views.insert(procgui::LSystemView(ext::sf::Vector2d(real_mouse_position(sf::Mouse::getPosition(window)))));
             }
             if (ImGui::MenuItem("Load LSystem", "Ctrl+O"))
             {
                 mouse_position_to_load_ = real_mouse_position(sf::Mouse::getPosition(window));
                 load_menu_open_ = true;
             }
+            if (!lsys_views.empty() && ImGui::MenuItem("Save scene"))
+            {
+                save_scene_ = true;
+                save_menu_open_ = true;
+            }
             ImGui::Separator();
             if (LSystemController::saved_view() && ImGui::MenuItem("Paste", "Ctrl+V"))
             {
                 paste_view(lsys_views, LSystemController::saved_view(), real_mouse_position(sf::Mouse::getPosition(window)));
             }
+            ImGui::Separator();
+            if (ImGui::MenuItem("Export performance trace"))
+            {
+                std::ofstream ofs (trace_file_);
+                Profiler::export_chrome_trace(ofs);
+            }
+            if (DiskCache::is_open() && ImGui::MenuItem("Clear disk cache"))
+            {
+                DiskCache::clear();
+            }
             ImGui::EndPopup();
         }
     }
 
-    void WindowController::save_menu()
+    void WindowController::save_menu(const procgui::SceneRegistry& lsys_views)
     {
         // The file name in which will be save the LSystem.
         static std::array<char, FILENAME_LENGTH_> filename;
@@ -116,6 +135,10 @@ namespace controller
         static bool dir_error_popup = false;
         // Flag to let the file error popup open between frames.
         static bool file_error_popup = false;
+        // The format of the file and the embedding of the geometry in the
+        // binary format.
+        static int format = static_cast<int>(procgui::LSystemView::SaveFormat::JSON);
+        static bool embed_geometry = true;
 
         ImGui::SetNextWindowPosCenter();
         if (ImGui::Begin("Save LSystem to file", &save_menu_open_, ImGuiWindowFlags_AlwaysAutoResize|ImGuiWindowFlags_NoCollapse|ImGuiWindowFlags_NoSavedSettings))
@@ -125,43 +148,9 @@ namespace controller
             ImGui::CaptureMouseFromApp();
 
             ImGui::Separator();
-            try
-            {
-                std::vector<fs::directory_entry> files;
-                // Get all files in the 'save_dir_', ...
-                for (const auto& file : fs::directory_iterator(save_dir_))
-                {
-                    files.emplace_back(file);
-                }
-
-                // ... sort them lexicographically, ...
-                std::sort(begin(files), end(files),
-                          [](const auto& left, const auto& right)
-                          {
-                              auto left_str = left.path().string();
-                              std::transform(begin(left_str), end(left_str), begin(left_str),
-                                             [](unsigned char c){return std::tolower(c);});
-                              auto right_str = right.path().string();
-                              std::transform(begin(right_str), end(right_str), begin(right_str),
-                                             [](unsigned char c){return std::tolower(c);});
-                              return left_str < right_str;                          
-                          });
-
-                for (const auto& file : files)
-                {
-                   // ... display them in a selectable list ...
-                   if (fs::is_regular_file(file.path()) &&
-                        ImGui::Selectable(file.path().filename().c_str()))
-                    {
-                        // ... and set 'filename' to if one is clicked (to overwrite this file).
-                        filename = string_to_array<filename.size()>(file.path().filename());
-                    }
-                }
-            }
-            catch (const fs::filesystem_error& e)
+            if (!save_files_list(filename))
             {
                 // If we can't open 'save_dir_', open an error popup.
-
                 dir_error_popup = true;
             }
 
@@ -188,6 +177,23 @@ namespace controller
             ImGui::InputText("Filename", filename.data(), filename.size());
             std::string trimmed_filename = array_to_string(filename);
             trim(trimmed_filename);
+
+            // Save all the LSystems instead of the one under the mouse.
+            ImGui::Checkbox("Whole scene", &save_scene_);
+
+            // Format of the file.
+            ImGui::RadioButton("JSON", &format, static_cast<int>(procgui::LSystemView::SaveFormat::JSON));
+            ImGui::SameLine();
+            ImGui::RadioButton("Binary", &format, static_cast<int>(procgui::LSystemView::SaveFormat::Binary));
+            if (format == static_cast<int>(procgui::LSystemView::SaveFormat::Binary))
+            {
+                ImGui::SameLine();
+                ImGui::Checkbox("Embed geometry", &embed_geometry);
+                if (ImGui::IsItemHovered())
+                {
+                    ImGui::SetTooltip("Save the computed vertices in the file: loading it does not derive and interpret the LSystem again. The file is much larger.");
+                }
+            }
             
             ImGui::Separator();
 
@@ -195,7 +201,7 @@ namespace controller
             if (ImGui::Button("Save") && !trimmed_filename.empty())
             {
                 // Open the output file.
-                std::ofstream ofs (save_dir_/trimmed_filename);
+                std::ofstream ofs (save_dir_/trimmed_filename, std::ios::binary);
 
                 // Open the error popup if we can not open the file.
                 if(!ofs.is_open())
@@ -204,12 +210,19 @@ namespace controller
                 }
                 else
                 {
+                    auto save_format = static_cast<procgui::LSystemView::SaveFormat>(format);
+                    if (save_scene_)
+                    {
+                        // Save all the LSystemViews in the file.
+                        procgui::LSystemView::save_scene(ofs, lsys_views.views(), save_format, embed_geometry);
+                    }
                     // Save the LSystemView in the file.
-                    cereal::JSONOutputArchive archive (ofs);
-                    if (LSystemController::under_mouse()) // Virtually useless check.
+                    else if (LSystemController::under_mouse(lsys_views)) // Virtually useless check.
                     {
-                        archive(cereal::make_nvp("LSystemView", *LSystemController::under_mouse()));
+                        LSystemController::under_mouse(lsys_views)->save_file(ofs, save_format, embed_geometry);
                     }
+                    // Display the new file without waiting for the polling.
+                    save_index_->refresh();
                     save_menu_open_ = false;
                 }
             }
@@ -237,7 +250,53 @@ namespace controller
         }
     }
 
-    void WindowController::load_menu(std::list<procgui::LSystemView>& lsys_views)
+    bool WindowController::save_files_list(std::array<char, FILENAME_LENGTH_>& filename)
+    {
+        // The filter of the list, shared by the save and load menus.
+        static std::array<char, FILENAME_LENGTH_> pattern;
+        // The filtered list is computed again only if the pattern or the
+        // list of files changed.
+        static std::string filtered_pattern;
+        static std::shared_ptr<const DirectoryIndex::Files> files;
+        static std::vector<std::size_t> filtered;
+
+        if (!save_index_)
+        {
+            save_index_ = std::make_unique<DirectoryIndex>(save_dir_);
+        }
+
+        ImGui::InputText("Filter", pattern.data(), pattern.size());
+        auto latest_files = save_index_->get_files();
+        auto pattern_str = array_to_string(pattern);
+        if (latest_files != files || pattern_str != filtered_pattern)
+        {
+            files = latest_files;
+            filtered_pattern = pattern_str;
+            filtered = DirectoryIndex::filter(*files, filtered_pattern);
+        }
+
+        // Only the visible files are submitted to ImGui.
+        ImGui::BeginChild("Files", ImVec2(400, 10 * ImGui::GetTextLineHeightWithSpacing()), true);
+        ImGuiListClipper clipper (filtered.size());
+        while (clipper.Step())
+        {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+            {
+                const auto& file = files->at(filtered[i]);
+                if (ImGui::Selectable(file.filename.c_str()))
+                {
+                    // Set 'filename' to the one clicked (to overwrite or
+                    // load this file).
+                    filename = string_to_array<FILENAME_LENGTH_>(file.filename);
+                }
+            }
+        }
+        ImGui::EndChild();
+
+        return save_index_->is_valid();
+    }
+
+    void WindowController::load_menu(procgui::SceneRegistry& lsys_views)
     {
         // The file name in which will be save the LSystem.
         static std::array<char, FILENAME_LENGTH_> filename;
@@ -254,40 +313,7 @@ namespace controller
             ImGui::CaptureMouseFromApp();
 
             ImGui::Separator();
-            try
-            {
-                std::vector<fs::directory_entry> files;
-                // Get all files in the 'save_dir_' directory, ...
-                for (const auto& file : fs::directory_iterator(save_dir_))
-                {
-                    files.emplace_back(file);
-                }
-                // ... sort them lexicographically, ...
-                std::sort(begin(files), end(files),
-                          [](const auto& left, const auto& right)
-                          {
-                              auto left_str = left.path().string();
-                              std::transform(begin(left_str), end(left_str), begin(left_str),
-                                             [](unsigned char c){return std::tolower(c);});
-                              auto right_str = right.path().string();
-                              std::transform(begin(right_str), end(right_str), begin(right_str),
-                                             [](unsigned char c){return std::tolower(c);});
-                              return left_str < right_str;                          
-                          });
-
-                for (const auto& file : files)
-                {
-                    // ... displays them in a selectable list ...
-                    if (fs::is_regular_file(file.path()) &&
-                        ImGui::Selectable(file.path().filename().c_str()))
-                    {
-                        // ... and set 'filename' to the one clicked (to
-                        // load this file).
-                        filename = string_to_array<filename.size()>(file.path().filename());
-                    }
-                }
-            }
-            catch (const fs::filesystem_error& e)
+            if (!save_files_list(filename))
             {
                 // If we can't open 'save_dir_', open an error popup.
                 dir_error_popup = true;
@@ -320,7 +346,7 @@ namespace controller
             if (ImGui::Button("Load"))
             {
                 // Open the input file.
-                std::ifstream ifs (save_dir_/array_to_string(filename));
+                std::ifstream ifs (save_dir_/array_to_string(filename), std::ios::binary);
 
                 // Open the error popup if we can not open the file.
                 if(!ifs.is_open())
@@ -329,27 +355,34 @@ namespace controller
                 }
                 else
                 {
-                    // Create a default LSystemView.
-                    procgui::LSystemView loaded_view({0,0});
                     try
                     {
-                        // Load it from the file.
-                        cereal::JSONInputArchive archive (ifs);
-                        archive(loaded_view);
+                        // Load it from the file, in any format. The views
+                        // are moved into 'lsys_views': they are not copied.
+                        if (procgui::LSystemView::is_scene(ifs))
+                        {
+                            // The views of a scene keep their positions.
+                            for (auto& view : procgui::LSystemView::load_scene(ifs))
+                            {
+                                lsys_views.insert(std::move(view));
+                            }
+                        }
+                        else
+                        {
+                            // Place the new LSystemView at the correct
+                            // position.
+                            auto loaded_view = procgui::LSystemView::load_file(ifs);
+                            place_view(loaded_view, mouse_position_to_load_);
+                            lsys_views.insert(std::move(loaded_view));
+                        }
+                        load_menu_open_ = false;
                     }
-                    catch (const cereal::RapidJSONException& e)
+                    catch (const cereal::Exception& e)
                     {
                         // If the file is not in the correct format, open the
                         // error popup. 
                         file_error_popup = true;
                     }
-                    if (!file_error_popup)
-                    {
-                        // Paste the new LSystemView at the correct position.
-                        auto tmp = std::make_optional(loaded_view);
-                        paste_view(lsys_views, tmp, mouse_position_to_load_, true);
-                        load_menu_open_ = false;
-                    }
                 }
             }
 
@@ -378,7 +411,7 @@ namespace controller
     
     void WindowController::handle_input(std::vector<sf::Event> events,
                                         sf::RenderWindow &window,
-                                        std::list<procgui::LSystemView>& lsys_views)
+                                        procgui::SceneRegistry& lsys_views)
     {
         ImGuiIO& imgui_io = ImGui::GetIO();
 
@@ -407,7 +440,7 @@ namespace controller
                 }
                 else if (event.key.code == sf::Keyboard::N)
                 {
-                    lsys_views.emplace_front(ext::sf::Vector2d(real_mouse_position(sf::Mouse::getPosition(window))));
+                    lsys_views.insert(procgui::LSystemView(ext::sf::Vector2d(real_mouse_position(sf::Mouse::getPosition(window)))));
                 }
                 else if (event.key.code == sf::Keyboard::O)
                 {
@@ -468,7 +501,13 @@ namespace controller
 
         if (save_menu_open_)
         {
-            save_menu();
+            save_menu(lsys_views);
+        }
+        else
+        {
+            // The scene is only saved when requested from the right-click
+            // menu.
+            save_scene_ = false;
         }
         if (load_menu_open_)
         {
@@ -501,7 +540,7 @@ namespace controller
                 {
                     // If LSystemView management has priority, let them have the
                     // control over the dragging behaviour.
-                    LSystemController::handle_delta(sf::Vector2f(mouse_delta) * zoom_level_);
+                    LSystemController::handle_delta(lsys_views, sf::Vector2f(mouse_delta) * zoom_level_);
                 }
                 else
                 {
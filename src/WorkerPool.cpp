@@ -0,0 +1,83 @@
+#include <gsl/gsl>
+#include "WorkerPool.h"
+
+namespace
+{
+    // Set in the threads of the pools.
+    thread_local bool is_worker_thread_ {false};
+}
+
+// Exception:
+//  - Precondition: 'n_threads' must be strictly positive.
+WorkerPool::WorkerPool(unsigned n_threads)
+{
+    Expects(n_threads > 0);
+    for (auto i=0u; i<n_threads; ++i)
+    {
+        threads_.emplace_back([this](){work();});
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    shutdown();
+}
+
+void WorkerPool::shutdown()
+{
+    // The discarded tasks are destroyed outside of the lock: their futures
+    // are broken at their destruction.
+    std::deque<std::function<void()>> discarded;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        stop_ = true;
+        discarded.swap(tasks_);
+    }
+    condition_.notify_all();
+    discarded.clear();
+    for (auto& thread : threads_)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+}
+
+std::size_t WorkerPool::size() const
+{
+    return threads_.size();
+}
+
+unsigned WorkerPool::default_thread_count()
+{
+    // 'hardware_concurrency()' may return 0 if the value is not computable.
+    auto hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 1;
+}
+
+bool WorkerPool::is_worker_thread()
+{
+    return is_worker_thread_;
+}
+
+void WorkerPool::work()
+{
+    is_worker_thread_ = true;
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock (mutex_);
+            condition_.wait(lock, [this](){return stop_ || !tasks_.empty();});
+            if (stop_)
+            {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        // The exceptions are stored in the future by 'std::packaged_task'.
+        task();
+    }
+}
@@ -1,9 +1,160 @@
+#include <algorithm>
+#include <array>
+#include <iterator>
+#if defined(__SSE__)
+#include <immintrin.h>
+#endif
 #include <gsl/gsl>
 #include "geometry.h"
 #include "helper_math.h"
+#include "WorkerPool.h"
 
 namespace geometry
 {
+    namespace
+    {
+        // Below this number of vertices, the computations are not split
+        // between threads.
+        constexpr std::size_t parallel_threshold = 1 << 18;
+
+        // The threads of the parallel computations, created once.
+        WorkerPool& kernel_workers()
+        {
+            static WorkerPool workers;
+            return workers;
+        }
+
+        // The number of parallel calls worth it for 'n_vertices' vertices: 1
+        // for small sets, or if the caller is already a worker (for example
+        // computing a geometry in the background) to not oversubscribe the
+        // CPU.
+        std::size_t parallel_count(std::size_t n_vertices)
+        {
+            if (n_vertices < 2 * parallel_threshold || WorkerPool::is_worker_thread())
+            {
+                return 1;
+            }
+            return std::min(kernel_workers().size() + 1, n_vertices / parallel_threshold);
+        }
+
+        // Call 'f(i)' for each 'i' in [0, count): the first call in the
+        // current thread, the others in 'kernel_workers()'. The calls
+        // reference 'f', so all the submitted calls are finished before
+        // leaving, even if a call or a submission throws.
+        template<typename F>
+        void parallel_for(std::size_t count, F&& f)
+        {
+            std::vector<std::future<void>> calls;
+            auto wait_calls = [&calls]()
+                {
+                    for (auto& call : calls)
+                    {
+                        call.wait();
+                    }
+                };
+            try
+            {
+                calls.reserve(count > 0 ? count - 1 : 0);
+                for (std::size_t i = 1; i < count; ++i)
+                {
+                    calls.push_back(kernel_workers().submit([&f, i](){f(i);}));
+                }
+                if (count > 0)
+                {
+                    f(0);
+                }
+            }
+            catch (...)
+            {
+                wait_calls();
+                throw;
+            }
+            wait_calls();
+            for (auto& call : calls)
+            {
+                call.get();
+            }
+        }
+
+        // The extrema of the positions of a set of vertices.
+        struct Extrema
+        {
+            float left, top, right, down;
+
+            // Same comparisons as a sequential computation on the
+            // concatenation of the two sets of vertices.
+            void merge(const Extrema& other)
+            {
+                left = other.left < left ? other.left : left;
+                top = other.top < top ? other.top : top;
+                right = other.right > right ? other.right : right;
+                down = other.down > down ? other.down : down;
+            }
+
+            sf::FloatRect rect() const
+            {
+                return {left, top, right - left, down - top};
+            }
+        };
+
+        // Compute the extrema of the vertices in [first, last).
+        // 'first' must be strictly inferior to 'last'.
+        //
+        // The SSE implementation loads the 2D position of two vertices in a
+        // single register ([x0, y0, x1, y1]) and reduce the lanes at the end:
+        // the stride of sf::Vertex (20 bytes) prevents aligned loads of
+        // positions only. The operands order of the min/max instructions
+        // keeps the current extremum on equality and on NaN, like the
+        // comparisons of the scalar implementation.
+        Extrema extrema(const sf::Vertex* first, const sf::Vertex* last)
+        {
+            Expects(first < last);
+#if defined(__SSE__)
+            auto load_pair = [](const sf::Vertex* v)
+                {
+                    __m128 pair = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(&v[0].position));
+                    return _mm_loadh_pi(pair, reinterpret_cast<const __m64*>(&v[1].position));
+                };
+            __m128 minimum = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(&first->position));
+            minimum = _mm_movelh_ps(minimum, minimum);
+            __m128 maximum = minimum;
+            for (; first + 1 < last; first += 2)
+            {
+                __m128 positions = load_pair(first);
+                minimum = _mm_min_ps(positions, minimum);
+                maximum = _mm_max_ps(positions, maximum);
+            }
+            if (first < last)
+            {
+                __m128 position = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(&first->position));
+                position = _mm_movelh_ps(position, position);
+                minimum = _mm_min_ps(position, minimum);
+                maximum = _mm_max_ps(position, maximum);
+            }
+
+            // Reduce the two vertices of the registers.
+            minimum = _mm_min_ps(_mm_movehl_ps(minimum, minimum), minimum);
+            maximum = _mm_max_ps(_mm_movehl_ps(maximum, maximum), maximum);
+            alignas(16) std::array<float, 4> min_lanes, max_lanes;
+            _mm_store_ps(min_lanes.data(), minimum);
+            _mm_store_ps(max_lanes.data(), maximum);
+            return {min_lanes[0], min_lanes[1], max_lanes[0], max_lanes[1]};
+#else
+            // Warning: 'top' is at low value because of the axes defined by SFML.
+            Extrema extrema {first->position.x, first->position.y, first->position.x, first->position.y};
+            for (; first < last; ++first)
+            {
+                const auto& p = first->position;
+                extrema.left = p.x < extrema.left ? p.x : extrema.left;
+                extrema.top = p.y < extrema.top ? p.y : extrema.top;
+                extrema.right = p.x > extrema.right ? p.x : extrema.right;
+                extrema.down = p.y > extrema.down ? p.y : extrema.down;
+            }
+            return extrema;
+#endif
+        }
+    }
+    
     float distance (const sf::Vector2f& a, const sf::Vector2f& b)
     {
         return std::sqrt(std::pow(b.x-a.x, 2)+std::pow(b.y-a.y, 2));
@@ -92,33 +243,30 @@ namespace geometry
         {
             return { 0, 0, 0, 0 };
         }
-        const auto& first = vertices.at(0);
-        // Warning: 'top' is at low value because of the axes defined by SFML.
-        float top = first.position.y, down = first.position.y;
-        float left = first.position.x, right = first.position.x;
 
-        // For each vertices, update the bounding box coordinates if necessary.
-        for (const auto& v : vertices)
+        std::size_t n_chunks = parallel_count(vertices.size());
+        if (n_chunks <= 1)
         {
-            if (v.position.y < top)
-            {
-                top = v.position.y;
-            }
-            else if (v.position.y > down)
-            {
-                down = v.position.y;
-            }
+            return extrema(vertices.data(), vertices.data() + vertices.size()).rect();
+        }
 
-            if (v.position.x > right)
-            {
-                right = v.position.x;
-            }
-            else if (v.position.x < left)
-            {
-                left = v.position.x;
-            }
+        // Compute the extrema of each chunk in parallel and merge them in
+        // order.
+        std::vector<Extrema> chunks (n_chunks);
+        std::size_t chunk_size = vertices.size() / n_chunks;
+        parallel_for(n_chunks, [&vertices, &chunks, chunk_size, n_chunks](std::size_t i)
+                     {
+                         const auto* first = vertices.data() + i * chunk_size;
+                         const auto* last = i == n_chunks - 1 ?
+                             vertices.data() + vertices.size() : first + chunk_size;
+                         chunks[i] = extrema(first, last);
+                     });
+        Extrema result = chunks.front();
+        for (auto it = std::next(begin(chunks)); it != end(chunks); ++it)
+        {
+            result.merge(*it);
         }
-        return {left, top, right - left, down - top};
+        return result.rect();
     }
     
     std::vector<sf::FloatRect> sub_boxes(const std::vector<sf::Vertex>& vertices,
@@ -133,8 +281,6 @@ namespace geometry
             max_boxes = 2;
         }
 
-        std::vector<sf::FloatRect> boxes;
-
         // Each bounding_box must have rougly the same number of
         // vertices. However, it can not be exact: the number of vertices may
         // not be a multiple of the number of boxes. As a consequence the last
@@ -142,7 +288,7 @@ namespace geometry
         // the number of 'max_boxes', we divide by 'max_boxes-1'.
         // Edge case: If 'max_boxes' is equal to 1 or 2, it will be a single
         // bounding box, as there is not any remainder.
-        int vertices_per_box = vertices.size()  / (max_boxes-1);
+        std::size_t vertices_per_box = vertices.size()  / (max_boxes-1);
 
         // The algorithm makes overlapping boxes. We must have a least 4
         // vertices per box.
@@ -152,33 +298,121 @@ namespace geometry
         // 'max_boxes'
         vertices_per_box = vertices_per_box < 4 ? 4 : vertices_per_box;
 
-        int n = 0;
-        std::vector<sf::Vertex> box_vertices;
-        for (size_t i = 0; i<vertices.size(); ++i)
+        // The ranges of vertices of each box: a box starts 3 vertices before
+        // the end of the previous one to make overlapping boxes. The last box
+        // is the remainder of the vertices.
+        std::vector<std::pair<std::size_t, std::size_t>> ranges;
+        for (std::size_t first = 0; first < vertices.size(); first += vertices_per_box - 3)
+        {
+            std::size_t last = std::min(first + vertices_per_box, vertices.size());
+            ranges.push_back({first, last});
+            if (last == vertices.size())
+            {
+                break;
+            }
+        }
+
+        // The boxes are computed directly on the vertices, in parallel for
+        // large arrays.
+        std::vector<sf::FloatRect> boxes (ranges.size());
+        auto compute_box = [&vertices, &ranges, &boxes](std::size_t i)
+            {
+                boxes[i] = extrema(vertices.data() + ranges[i].first,
+                                   vertices.data() + ranges[i].second).rect();
+            };
+        std::size_t n_calls = parallel_count(vertices.size());
+        parallel_for(n_calls, [&ranges, &compute_box, n_calls](std::size_t call)
+                     {
+                         for (std::size_t i = call; i < ranges.size(); i += n_calls)
+                         {
+                             compute_box(i);
+                         }
+                     });
+
+        return boxes;
+    }
+
+    std::vector<sf::FloatRect> chunk_boxes(const std::vector<sf::Vertex>& vertices,
+                                           std::size_t chunk_size)
+    {
+        Expects(chunk_size > 0);
+
+        std::vector<sf::FloatRect> boxes;
+        for (std::size_t first = 0; first < vertices.size(); first += chunk_size)
+        {
+            // The chunk overlaps the next one by one vertex.
+            std::size_t last = std::min(first + chunk_size, vertices.size() - 1);
+            boxes.push_back(extrema(vertices.data() + first, vertices.data() + last + 1).rect());
+        }
+        return boxes;
+    }
+
+    std::vector<std::pair<std::size_t, std::size_t>> visible_ranges(const std::vector<sf::FloatRect>& boxes,
+                                                                    std::size_t chunk_size,
+                                                                    std::size_t n_vertices,
+                                                                    const sf::FloatRect& area)
+    {
+        std::vector<std::pair<std::size_t, std::size_t>> ranges;
+        for (std::size_t i = 0; i < boxes.size(); ++i)
         {
-            // Create a box when the number of vertices is attained
-            if (n == vertices_per_box)
+            if (!overlap(boxes[i], area))
             {
-                n = 0;
-                i -= 3; // Go back to count several time the number of vertices
-                        // to make overlapping boxes
-                boxes.push_back(bounding_box(box_vertices));
-                box_vertices.clear();
+                continue;
             }
 
-            // Add a vertex to the next box.
-            box_vertices.push_back(vertices.at(i));
-            ++n;
+            std::size_t first = i * chunk_size;
+            std::size_t last = std::min(first + chunk_size, n_vertices - 1);
+            // Merge with the previous range if the chunks are consecutive.
+            if (!ranges.empty() && ranges.back().first + ranges.back().second - 1 == first)
+            {
+                ranges.back().second = last - ranges.back().first + 1;
+            }
+            else
+            {
+                ranges.push_back({first, last - first + 1});
+            }
+        }
+        return ranges;
+    }
 
-            // For the final box, the remainder of the vertices does not attain
-            // 'vertices_per_box', so manually set it.
-            if (i == vertices.size()-1)
+    std::vector<sf::Vertex> simplify(const std::vector<sf::Vertex>& vertices,
+                                     float tolerance,
+                                     int color_tolerance)
+    {
+        if (vertices.size() <= 2)
+        {
+            return vertices;
+        }
+
+        auto differ = [color_tolerance](const sf::Color& a, const sf::Color& b)
+            {
+                return std::abs(a.r - b.r) > color_tolerance ||
+                    std::abs(a.g - b.g) > color_tolerance ||
+                    std::abs(a.b - b.b) > color_tolerance ||
+                    std::abs(a.a - b.a) > color_tolerance;
+            };
+
+        std::vector<sf::Vertex> simplified {vertices.front()};
+        const float squared_tolerance = tolerance * tolerance;
+        for (std::size_t i = 1; i < vertices.size() - 1; ++i)
+        {
+            const auto& v = vertices[i];
+            bool is_border = differ(v.color, vertices[i-1].color) || differ(v.color, vertices[i+1].color);
+            sf::Vector2f delta = v.position - simplified.back().position;
+            if (is_border || delta.x*delta.x + delta.y*delta.y > squared_tolerance)
             {
-                boxes.push_back(bounding_box(box_vertices));
+                simplified.push_back(v);
             }
         }
+        simplified.push_back(vertices.back());
+        return simplified;
+    }
 
-        return boxes;
+    bool overlap(const sf::FloatRect& a, const sf::FloatRect& b)
+    {
+        return
+            a.left <= b.left + b.width && b.left <= a.left + a.width &&
+            a.top <= b.top + b.height && b.top <= a.top + a.height;
     }
 
     void expand_boxes(std::vector<sf::FloatRect>& boxes, float expansion)
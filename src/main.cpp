@@ -9,12 +9,14 @@
 #include "cereal/archives/json.hpp"
 #include "cereal/types/vector.hpp"
 
+#include "DiskCache.h"
 #include "LSystem.h"
 #include "RuleMapBuffer.h"
 #include "InterpretationMapBuffer.h"
 #include "Turtle.h"
 #include "helper_math.h"
 #include "procgui.h"
+#include "Profiler.h"
 #include "WindowController.h"
 #include "RenderWindow.h"
 
@@ -29,6 +31,9 @@ int main()
     window.setVerticalSyncEnabled(true);
     ImGui::SFML::Init(window);
 
+    // Persistent cache of the heavy computations between sessions.
+    DiskCache::open("cache");
+
     // auto serpinski = std::make_shared<LSystem>(LSystem { "F", { { 'F', "G-F-G" }, { 'G', "F+G+F" } } });
     auto plant = std::make_shared<LSystem>(LSystem { "X", { { 'X', "F[-X][X]F[-X]+FX" }, { 'F', "FF" } }, "X" });
     // auto fract = std::make_shared<LSystem>(LSystem { "F", { { 'F', "FF+F" } } });
@@ -60,14 +65,15 @@ int main()
     // LSystemView serpinski_view ("Serpinski", serpinski, map, serpinski_param);
     // LSystemView fract_view ("Fract", fract, map, fract_param);
     
-    std::list<LSystemView> views;
-    // views.push_back(std::move(serpinski_view));
-    views.push_back(std::move(plant_view));
-    // views.push_back(std::move(fract_view));
+    SceneRegistry views;
+    // views.insert(std::move(serpinski_view));
+    views.insert(std::move(plant_view));
+    // views.insert(std::move(fract_view));
 
     sf::Clock delta_clock;
     while (window.isOpen())
     {
+        Profiler::Scope frame_scope ("frame");
         window.clear();
 
         std::vector<sf::Event> events;
@@ -83,7 +89,10 @@ int main()
         // procgui::new_frame();
         ImGui::SFML::Update(window, delta_clock.restart());
         
-        WindowController::handle_input(events, window, views);
+        {
+            Profiler::Scope scope ("WindowController::handle_input", events.size());
+            WindowController::handle_input(events, window, views);
+        }
  
         for (auto& v : views)
         {
@@ -91,10 +100,15 @@ int main()
         }
         
 
-        ImGui::SFML::Render(window);
+        {
+            Profiler::Scope scope ("ImGui::SFML::Render");
+            ImGui::SFML::Render(window);
+        }
         window.display();
     }
 
+    // The background tasks must not outlive the static objects they use.
+    LSystemView::shutdown_workers();
     ImGui::SFML::Shutdown();
 
     return 0;
@@ -3,6 +3,7 @@
 #include <tuple>
 #include <chrono>
 #include "procgui.h"
+#include "Profiler.h"
 #include "helper_string.h"
 #include "WindowController.h"
 #include "RenderWindow.h"
@@ -1199,6 +1200,19 @@ namespace procgui
             return;
         }
 
+        // Busy indicator: the previous vertices are displayed until the
+        // background computation finishes.
+        if (lsys_view.is_computing())
+        {
+            ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Computing...");
+        }
+        if (auto refused = lsys_view.get_refused_vertices())
+        {
+            ImGui::TextColored(ImVec4(1.f, 0.f, 0.f, 1.f), "Too many vertices (%llu): not computed.",
+                               static_cast<unsigned long long>(refused));
+            ImGui::SameLine(); ext::ImGui::ShowHelpMarker("Reduce the number of iterations, or activate the adaptive depth or the visible region only.");
+        }
+
         push_embedded();
         interact_with(lsys_view.ref_parameters(), "Drawing Parameters"+ss.str());
         interact_with(lsys_view.ref_lsystem_buffer(), "LSystem"+ss.str());
@@ -1206,6 +1220,93 @@ namespace procgui
         interact_with(lsys_view.ref_vertex_painter_wrapper(), "Painter");
         pop_embedded();
 
+        // --- Progressive refinement ---
+        bool is_progressive = lsys_view.is_progressive();
+        if (ImGui::Checkbox("Progressive refinement", &is_progressive))
+        {
+            lsys_view.set_progressive(is_progressive);
+        }
+        ImGui::SameLine(); ext::ImGui::ShowHelpMarker("While a new iteration is computed, display the previous one scaled to the estimated size, then the partial drawing of the new iteration.");
+
+        // --- Adaptive depth ---
+        bool is_adaptive = lsys_view.is_adaptive();
+        if (ImGui::Checkbox("Adaptive depth", &is_adaptive))
+        {
+            lsys_view.set_adaptive(is_adaptive);
+        }
+        ImGui::SameLine(); ext::ImGui::ShowHelpMarker("Stop expanding the symbols whose drawing would be smaller than a pixel at the current zoom: they are drawn as a single segment. The drawing is computed again when the zoom changes.");
+
+        // --- Restriction to the viewport ---
+        bool is_restricted = lsys_view.is_restricted();
+        if (ImGui::Checkbox("Visible region only", &is_restricted))
+        {
+            lsys_view.set_restricted(is_restricted);
+        }
+        ImGui::SameLine(); ext::ImGui::ShowHelpMarker("Only compute the part of the drawing around the window, to zoom deeply into high iterations. The drawing is computed again when the view moves away.");
+
+        // --- Update statistics ---
+        const auto& counters = lsys_view.get_scheduler().get_counters();
+        ImGui::Text("Interpretations: %lu - Paintings: %lu - Coalesced: %lu",
+                    counters.executions.at(UpdateScheduler::Interpret),
+                    counters.executions.at(UpdateScheduler::Paint),
+                    counters.coalesced());
+        ImGui::SameLine(); ext::ImGui::ShowHelpMarker("Number of computations done since the creation of the view, and number of computations avoided by applying all the modifications once per frame.");
+
+        // --- Performance statistics ---
+        if (ImGui::CollapsingHeader(("Performance"+ss.str()).c_str()))
+        {
+            // The latest measure of each stage of the view.
+            const std::array<const char*, 7> stages =
+                {"drawing::compute_vertices",
+                 "drawing::compute_vertices_adaptive",
+                 "LSystemView::transform_geometry",
+                 "LSystemView::compute_boxes",
+                 "LSystemView::paint_vertices",
+                 "LSystemView::build_lod_levels",
+                 "LSystemView::draw"};
+            // The allocations are only shown if they are counted.
+            const bool allocations = Profiler::COUNTS_ALLOCATIONS;
+            ImGui::Columns(allocations ? 4 : 3, ("performance"+ss.str()).c_str());
+            ImGui::Text("Stage"); ImGui::NextColumn();
+            ImGui::Text("Time (ms)"); ImGui::NextColumn();
+            ImGui::Text("Items"); ImGui::NextColumn();
+            if (allocations)
+            {
+                ImGui::Text("Allocated (KiB)"); ImGui::NextColumn();
+            }
+            ImGui::Separator();
+            for (const auto& stage : stages)
+            {
+                auto sample = Profiler::latest(lsys_view.get_id(), stage);
+                ImGui::Text("%s", stage); ImGui::NextColumn();
+                if (sample)
+                {
+                    ImGui::Text("%.3f", sample->duration.count() / 1000.); ImGui::NextColumn();
+                    ImGui::Text("%lu", sample->items); ImGui::NextColumn();
+                    if (allocations)
+                    {
+                        ImGui::Text("%.1f", sample->allocated_bytes / 1024.); ImGui::NextColumn();
+                    }
+                }
+                else
+                {
+                    ImGui::Text("-"); ImGui::NextColumn();
+                    ImGui::Text("-"); ImGui::NextColumn();
+                    if (allocations)
+                    {
+                        ImGui::Text("-"); ImGui::NextColumn();
+                    }
+                }
+            }
+            ImGui::Columns(1);
+            if (allocations)
+            {
+                ImGui::Text("Heap: %.1f MiB", Profiler::live_bytes() / (1024. * 1024.));
+                ImGui::SameLine();
+            }
+            ext::ImGui::ShowHelpMarker("Latest measure of each stage. 'drawing::compute_vertices' includes the expansion of the rules. The complete trace can be exported with the right-click menu.");
+        }
+
         conclude();
 
         if (embedded_level == 0)
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <gtest/gtest.h>
+#include "cereal/archives/portable_binary.hpp"
+#include "BoxTree.h"
+
+using namespace geometry;
+
+namespace
+{
+    // Random small boxes in [0, 1000]^2.
+    std::vector<sf::FloatRect> random_boxes(std::size_t n)
+    {
+        std::mt19937 generator (42);
+        std::uniform_real_distribution<float> position (0, 1000);
+        std::uniform_real_distribution<float> size (0, 10);
+        std::vector<sf::FloatRect> boxes;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            boxes.push_back({position(generator), position(generator), size(generator), size(generator)});
+        }
+        return boxes;
+    }
+
+    float distance_to_center(const sf::FloatRect& box, const sf::Vector2f& point)
+    {
+        sf::Vector2f center {box.left + box.width / 2, box.top + box.height / 2};
+        return std::hypot(center.x - point.x, center.y - point.y);
+    }
+}
+
+TEST(BoxTreeTest, empty)
+{
+    BoxTree tree;
+    bool visited = false;
+    tree.query({0, 0, 10, 10}, [&visited](std::size_t){visited = true;});
+    auto [item, distance] = tree.nearest({0, 0}, 10, [](std::size_t){return 0.f;});
+
+    ASSERT_FALSE(visited);
+    ASSERT_EQ(item, tree.size());
+    ASSERT_TRUE(std::isinf(distance));
+}
+
+// The query returns the same items as a linear search.
+TEST(BoxTreeTest, query)
+{
+    auto boxes = random_boxes(1000);
+    BoxTree tree (boxes);
+    sf::FloatRect area {100, 200, 150, 50};
+
+    std::vector<std::size_t> expected;
+    for (std::size_t i = 0; i < boxes.size(); ++i)
+    {
+        if (overlap(boxes[i], area))
+        {
+            expected.push_back(i);
+        }
+    }
+    std::vector<std::size_t> found;
+    tree.query(area, [&found](std::size_t i){found.push_back(i);});
+    std::sort(begin(found), end(found));
+
+    ASSERT_EQ(tree.size(), boxes.size());
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(expected, found);
+}
+
+// The nearest item is the same as with a linear search.
+TEST(BoxTreeTest, nearest)
+{
+    auto boxes = random_boxes(1000);
+    BoxTree tree (boxes);
+    sf::Vector2f point {500, 500};
+    auto distance = [&boxes, &point](std::size_t i){return distance_to_center(boxes[i], point);};
+
+    std::size_t expected = 0;
+    for (std::size_t i = 0; i < boxes.size(); ++i)
+    {
+        if (distance(i) < distance(expected))
+        {
+            expected = i;
+        }
+    }
+    auto [item, item_distance] = tree.nearest(point, 1000, distance);
+    ASSERT_EQ(expected, item);
+    ASSERT_FLOAT_EQ(distance(expected), item_distance);
+
+    // Nothing closer than the maximum distance.
+    auto [none, none_distance] = tree.nearest(point, item_distance / 2, distance);
+    ASSERT_EQ(tree.size(), none);
+    ASSERT_TRUE(std::isinf(none_distance));
+}
+
+// A loaded tree answers the queries like the saved one.
+TEST(BoxTreeTest, serialization)
+{
+    auto boxes = random_boxes(1000);
+    BoxTree tree (boxes);
+    BoxTree loaded;
+
+    std::stringstream ss;
+    {
+        cereal::PortableBinaryOutputArchive oarchive (ss);
+        oarchive(tree);
+    }
+    {
+        cereal::PortableBinaryInputArchive iarchive (ss);
+        iarchive(loaded);
+    }
+
+    sf::FloatRect area {100, 200, 150, 50};
+    std::vector<std::size_t> expected;
+    tree.query(area, [&expected](std::size_t i){expected.push_back(i);});
+    std::vector<std::size_t> found;
+    loaded.query(area, [&found](std::size_t i){found.push_back(i);});
+    ASSERT_EQ(tree.size(), loaded.size());
+    ASSERT_EQ(expected, found);
+
+    // A corrupted tree is rejected.
+    std::string corrupted = ss.str();
+    corrupted.resize(corrupted.size() / 2);
+    std::stringstream css (corrupted);
+    cereal::PortableBinaryInputArchive iarchive (css);
+    ASSERT_THROW(iarchive(loaded), cereal::Exception);
+}
@@ -0,0 +1,103 @@
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <gtest/gtest.h>
+#include "DirectoryIndex.h"
+
+namespace fs = std::experimental::filesystem;
+using namespace std::chrono_literals;
+
+class DirectoryIndexTest : public ::testing::Test
+{
+public:
+    DirectoryIndexTest()
+        {
+            fs::remove_all(directory);
+            fs::create_directories(directory / "subdirectory");
+            create_file("b.txt");
+            create_file("A.txt");
+            create_file("c");
+        }
+    ~DirectoryIndexTest()
+        {
+            fs::remove_all(directory);
+        }
+
+    void create_file(const std::string& filename)
+        {
+            std::ofstream ofs (directory / filename);
+        }
+
+    // Wait until the generation of 'index' is greater than 'generation'.
+    bool wait_change(const DirectoryIndex& index, unsigned long generation)
+        {
+            for (int i = 0; i < 500 && index.get_generation() == generation; ++i)
+            {
+                std::this_thread::sleep_for(10ms);
+            }
+            return index.get_generation() > generation;
+        }
+
+    std::vector<std::string> filenames(const DirectoryIndex& index)
+        {
+            std::vector<std::string> names;
+            for (const auto& file : *index.get_files())
+            {
+                names.push_back(file.filename);
+            }
+            return names;
+        }
+
+    fs::path directory {fs::temp_directory_path() / "procgen_directory_index_test"};
+};
+
+// The regular files are sorted case-insensitively.
+TEST_F(DirectoryIndexTest, files)
+{
+    DirectoryIndex index (directory);
+    std::vector<std::string> expected {"A.txt", "b.txt", "c"};
+
+    ASSERT_TRUE(index.is_valid());
+    ASSERT_EQ(expected, filenames(index));
+    ASSERT_EQ("a.txt", index.get_files()->at(0).sort_key);
+}
+
+TEST_F(DirectoryIndexTest, filter)
+{
+    DirectoryIndex index (directory);
+    std::vector<std::size_t> expected_txt {0, 1};
+    std::vector<std::size_t> expected_all {0, 1, 2};
+
+    ASSERT_EQ(expected_txt, DirectoryIndex::filter(*index.get_files(), "TXT"));
+    ASSERT_EQ(expected_all, DirectoryIndex::filter(*index.get_files(), ""));
+    ASSERT_TRUE(DirectoryIndex::filter(*index.get_files(), "z").empty());
+}
+
+// The modifications of the directory are detected in the background.
+TEST_F(DirectoryIndexTest, refresh)
+{
+    DirectoryIndex index (directory, 10ms);
+    auto generation = index.get_generation();
+    auto files = index.get_files();
+
+    create_file("aa");
+    ASSERT_TRUE(wait_change(index, generation));
+    std::vector<std::string> expected {"A.txt", "aa", "b.txt", "c"};
+    ASSERT_EQ(expected, filenames(index));
+    // The previous list is not modified.
+    ASSERT_EQ(3u, files->size());
+
+    generation = index.get_generation();
+    fs::remove(directory / "c");
+    index.refresh();
+    ASSERT_TRUE(wait_change(index, generation));
+    expected.pop_back();
+    ASSERT_EQ(expected, filenames(index));
+}
+
+TEST_F(DirectoryIndexTest, invalid_directory)
+{
+    DirectoryIndex index (directory / "does_not_exist");
+    ASSERT_FALSE(index.is_valid());
+    ASSERT_TRUE(index.get_files()->empty());
+}
@@ -0,0 +1,134 @@
+#include <chrono>
+#include <thread>
+#include <gtest/gtest.h>
+#include "DiskCache.h"
+
+namespace fs = std::experimental::filesystem;
+using namespace drawing;
+
+class DiskCacheTest : public ::testing::Test
+{
+public:
+    DiskCacheTest()
+        {
+            fs::remove_all(directory);
+            DiskCache::open(directory, 1 << 20, 0);
+        }
+    ~DiskCacheTest()
+        {
+            DiskCache::close();
+            fs::remove_all(directory);
+        }
+
+    // Number of entries in the cache directory.
+    std::size_t count_entries() const
+        {
+            std::size_t count = 0;
+            for (const auto& file : fs::directory_iterator(directory))
+            {
+                count += file.path().extension() == ".entry";
+            }
+            return count;
+        }
+
+    fs::path directory {fs::temp_directory_path() / "procgen_disk_cache_test"};
+};
+
+TEST_F(DiskCacheTest, store_find)
+{
+    std::vector<int> numbers {1, 2, 3, 4, 5};
+    std::string text {"F+F-F"};
+    DiskCache::store(42, "", {gsl::as_bytes(gsl::make_span(numbers)),
+                              gsl::as_bytes(gsl::make_span(text.data(), text.size()))});
+
+    auto entry = DiskCache::find(42, "");
+    ASSERT_TRUE(entry);
+    ASSERT_EQ(2u, entry->n_blocks());
+    auto loaded_numbers = entry->block<int>(0);
+    auto loaded_text = entry->block<char>(1);
+    ASSERT_EQ(numbers, std::vector<int>(loaded_numbers.begin(), loaded_numbers.end()));
+    ASSERT_EQ(text, std::string(loaded_text.begin(), loaded_text.end()));
+
+    ASSERT_FALSE(DiskCache::find(43, ""));
+}
+
+// An entry is only found with the identity it was stored with: a collision of
+// the keys is not served.
+TEST_F(DiskCacheTest, identity)
+{
+    std::vector<int> numbers {1, 2, 3};
+    DiskCache::store(42, "F+F", {gsl::as_bytes(gsl::make_span(numbers))});
+
+    ASSERT_FALSE(DiskCache::find(42, "F-F"));
+    ASSERT_FALSE(DiskCache::find(42, "F+F+"));
+    auto entry = DiskCache::find(42, "F+F");
+    ASSERT_TRUE(entry);
+    ASSERT_EQ(1u, entry->n_blocks());
+    auto loaded = entry->block<int>(0);
+    ASSERT_EQ(numbers, std::vector<int>(loaded.begin(), loaded.end()));
+}
+
+TEST_F(DiskCacheTest, closed)
+{
+    std::vector<int> numbers {1, 2, 3};
+    DiskCache::close();
+    DiskCache::store(42, "", {gsl::as_bytes(gsl::make_span(numbers))});
+    ASSERT_FALSE(DiskCache::find(42, ""));
+    ASSERT_FALSE(DiskCache::is_open());
+}
+
+TEST_F(DiskCacheTest, min_entry_bytes)
+{
+    DiskCache::open(directory, 1 << 20, 1024);
+    std::vector<int> small (10);
+    std::vector<int> large (1000);
+    DiskCache::store(1, "", {gsl::as_bytes(gsl::make_span(small))});
+    DiskCache::store(2, "", {gsl::as_bytes(gsl::make_span(large))});
+
+    ASSERT_FALSE(DiskCache::find(1, ""));
+    ASSERT_TRUE(DiskCache::find(2, ""));
+}
+
+// The least recently used entries are evicted first.
+TEST_F(DiskCacheTest, eviction)
+{
+    DiskCache::open(directory, 10000, 0);
+    std::vector<char> block (4000);
+    for (std::uint64_t key = 1; key <= 3; ++key)
+    {
+        DiskCache::store(key, "", {gsl::as_bytes(gsl::make_span(block))});
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        // Use the first entry: the second one is the least recently used.
+        DiskCache::find(1, "");
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_EQ(2u, count_entries());
+    ASSERT_TRUE(DiskCache::find(1, ""));
+    ASSERT_FALSE(DiskCache::find(2, ""));
+    ASSERT_TRUE(DiskCache::find(3, ""));
+
+    DiskCache::clear();
+    ASSERT_EQ(0u, count_entries());
+}
+
+TEST_F(DiskCacheTest, keys)
+{
+    LSystem lsys {"F", {{'F', "F+F"}}, ""};
+    LSystem other {"F", {{'F', "F-F"}}, ""};
+    DrawingParameters params {{0, 0}, 0, 1, 5, 3};
+    DrawingParameters moved {{100, 100}, 0, 1, 5, 3};
+    DrawingParameters rotated {{0, 0}, 1, 1, 5, 3};
+
+    // The starting position does not change the vertices.
+    auto map = default_interpretation_map;
+    ASSERT_EQ(DiskCache::geometry_key(lsys, map, params), DiskCache::geometry_key(lsys, map, moved));
+    ASSERT_NE(DiskCache::geometry_key(lsys, map, params), DiskCache::geometry_key(lsys, map, rotated));
+    ASSERT_NE(DiskCache::geometry_key(lsys, map, params), DiskCache::geometry_key(other, map, params));
+
+    // The key is the hash of the identity.
+    ASSERT_EQ(DiskCache::geometry_identity(lsys, map, params), DiskCache::geometry_identity(lsys, map, moved));
+    ASSERT_NE(DiskCache::geometry_identity(lsys, map, params), DiskCache::geometry_identity(other, map, params));
+    ASSERT_EQ(DiskCache::key(DiskCache::geometry_identity(lsys, map, params)),
+              DiskCache::geometry_key(lsys, map, params));
+}
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <sstream>
+#include <vector>
 #include <gtest/gtest.h>
 #include "cereal/archives/json.hpp"
 #include "DrawingParameters.h"
@@ -24,3 +25,49 @@ TEST(DrawingParametersTest, serialization)
     ASSERT_NEAR(oparams.get_step(), iparams.get_step(), 0.0001);
     ASSERT_EQ(oparams.get_n_iter(), iparams.get_n_iter());
 }
+
+// The observers know which field was modified.
+TEST(DrawingParametersTest, last_modified)
+{
+    using drawing::DrawingParameters;
+    DrawingParameters params;
+    std::vector<DrawingParameters::Field> fields;
+    params.add_observer([&params, &fields](){fields.push_back(params.get_last_modified());});
+
+    params.set_starting_position({10, 10});
+    params.set_starting_angle(1);
+    params.set_delta_angle(1);
+    params.set_step(1);
+    params.set_n_iter(1);
+
+    std::vector<DrawingParameters::Field> expected {DrawingParameters::StartingPosition,
+                                                    DrawingParameters::StartingAngle,
+                                                    DrawingParameters::DeltaAngle,
+                                                    DrawingParameters::Step,
+                                                    DrawingParameters::NIter};
+    ASSERT_EQ(expected, fields);
+}
+
+// A transaction modifying several fields notifies once with 'Several'.
+TEST(DrawingParametersTest, transaction)
+{
+    using drawing::DrawingParameters;
+    DrawingParameters params;
+    std::vector<DrawingParameters::Field> fields;
+    params.add_observer([&params, &fields](){fields.push_back(params.get_last_modified());});
+
+    {
+        Observable::Transaction transaction (params);
+        params.set_step(1);
+        params.set_step(2);
+    }
+    {
+        Observable::Transaction transaction (params);
+        params.set_step(3);
+        params.set_n_iter(2);
+    }
+
+    std::vector<DrawingParameters::Field> expected {DrawingParameters::Step,
+                                                    DrawingParameters::Several};
+    ASSERT_EQ(expected, fields);
+}
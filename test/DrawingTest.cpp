@@ -1,12 +1,15 @@
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 
 #include <gtest/gtest.h>
 #include <SFML/Graphics.hpp>
 #include "cereal/archives/json.hpp"
+#include "cereal/archives/portable_binary.hpp"
 
 #include "LSystem.h"
 #include "Turtle.h"
+#include "geometry.h"
 #include "InterpretationMap.h"
 
 
@@ -130,6 +133,175 @@ TEST_F(DrawingTest, compute_paths)
     ASSERT_EQ(iter, expected_iter);
 }
 
+// The partial vertices published during the computation are prefixes of the
+// final vertices.
+TEST_F(DrawingTest, partial_vertices)
+{
+    LSystem doubling { "F", { { 'F', "F+F" } }, "F" };
+    parameters.set_n_iter(14);
+    std::vector<std::vector<sf::Vertex>> partials;
+    auto [vertices, iter, _] = compute_vertices(doubling, interpretation, parameters, nullptr,
+                                                [&partials](const auto& partial_vertices, const auto&, int)
+                                                {
+                                                    partials.push_back(partial_vertices);
+                                                });
+
+    ASSERT_GT(partials.size(), 1u);
+    for (const auto& partial : partials)
+    {
+        ASSERT_LE(partial.size(), vertices.size());
+        ASSERT_TRUE(std::equal(begin(partial), end(partial), begin(vertices)));
+    }
+}
+
+// The vertices instanced from the records of the expansions are the
+// vertices of the interpretation of the production, up to the rounding
+// errors.
+TEST_F(DrawingTest, instanced_vertices)
+{
+    LSystem plant { "X", { { 'X', "F[+X]F[-X]+X" }, { 'F', "FF" } }, "X" };
+    parameters.set_n_iter(6);
+    auto [vertices, iter, max] = compute_vertices(plant, interpretation, parameters);
+
+    auto [str, rec, expected_max] = plant.produce(6);
+    impl::Turtle reference {parameters, rec};
+    for (auto c : str)
+    {
+        if (interpretation.has_predecessor(c))
+        {
+            interpretation.get_rule(c).second(reference);
+        }
+        ++reference.iteration_index;
+    }
+
+    ASSERT_EQ(reference.iteration_of_vertices, iter);
+    ASSERT_EQ(expected_max, max);
+    ASSERT_EQ(reference.vertices.size(), vertices.size());
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+    {
+        ASSERT_EQ(reference.vertices[i].color, vertices[i].color);
+        ASSERT_NEAR(reference.vertices[i].position.x, vertices[i].position.x, 1e-2);
+        ASSERT_NEAR(reference.vertices[i].position.y, vertices[i].position.y, 1e-2);
+    }
+}
+
+// The statistics are predicted without computing the vertices.
+TEST_F(DrawingTest, statistics)
+{
+    LSystem plant { "[+]X", { { 'X', "F[+X]F[-X]+X" }, { 'F', "FF" } }, "X" };
+    parameters.set_n_iter(6);
+    auto [vertices, iter, max] = compute_vertices(plant, interpretation, parameters);
+    unsigned long segments = 0;
+    for (std::size_t i = 0; i + 1 < vertices.size(); i += 2)
+    {
+        segments += vertices[i].color != sf::Color::Transparent ? 1 : 0;
+    }
+
+    auto statistics = compute_statistics(plant, interpretation, parameters);
+    ASSERT_EQ(segments, statistics.segments);
+    ASSERT_DOUBLE_EQ(segments * parameters.get_step(), statistics.length);
+    ASSERT_EQ(vertices.size(), statistics.vertices);
+    // The first save is never loaded: the drawing is not started.
+    ASSERT_EQ(7u, statistics.max_depth);
+    auto box = geometry::bounding_box(vertices);
+    ASSERT_NEAR(box.left, statistics.bounding_box.left, 1e-2);
+    ASSERT_NEAR(box.top, statistics.bounding_box.top, 1e-2);
+    ASSERT_NEAR(box.width, statistics.bounding_box.width, 1e-2);
+    ASSERT_NEAR(box.height, statistics.bounding_box.height, 1e-2);
+
+    auto counts = compute_statistics(plant, interpretation, parameters, false);
+    ASSERT_EQ(statistics.segments, counts.segments);
+    ASSERT_EQ(statistics.vertices, counts.vertices);
+    ASSERT_EQ(statistics.max_depth, counts.max_depth);
+}
+
+// Without minimal extent, the adaptive interpretation is the exact
+// interpretation. Otherwise, it draws fewer vertices, each less than the
+// minimal extent away from the exact drawing.
+TEST_F(DrawingTest, adaptive_vertices)
+{
+    LSystem plant { "X", { { 'X', "F[+X]F[-X]+X" }, { 'F', "FF" } }, "X" };
+    parameters.set_n_iter(6);
+    auto [exact, exact_iter, exact_max] = compute_vertices(plant, interpretation, parameters);
+
+    auto [same, same_iter, same_max] = compute_vertices_adaptive(plant, interpretation, parameters, 0);
+    ASSERT_EQ(exact, same);
+    ASSERT_EQ(exact_iter, same_iter);
+    ASSERT_EQ(exact_max, same_max);
+
+    double min_extent = 4 * parameters.get_step();
+    auto [adaptive, adaptive_iter, adaptive_max] =
+        compute_vertices_adaptive(plant, interpretation, parameters, min_extent);
+    ASSERT_LT(adaptive.size(), exact.size() / 2);
+    ASSERT_EQ(adaptive.size(), adaptive_iter.size());
+    ASSERT_EQ(exact_max, adaptive_max);
+    for (const auto& vertex : adaptive)
+    {
+        auto closest = std::min_element(begin(exact), end(exact),
+                                        [&vertex](const auto& a, const auto& b)
+                                        {
+                                            auto da = a.position - vertex.position;
+                                            auto db = b.position - vertex.position;
+                                            return da.x*da.x + da.y*da.y < db.x*db.x + db.y*db.y;
+                                        });
+        auto d = closest->position - vertex.position;
+        ASSERT_LT(std::sqrt(d.x*d.x + d.y*d.y), min_extent);
+    }
+}
+
+// The interpretation restricted to a region draws every segment of the exact
+// interpretation inside of it, with fewer vertices.
+TEST_F(DrawingTest, restricted_vertices)
+{
+    LSystem plant { "X", { { 'X', "F[+X]F[-X]+X" }, { 'F', "FF" } }, "X" };
+    parameters.set_n_iter(6);
+    auto [exact, exact_iter, exact_max] = compute_vertices(plant, interpretation, parameters);
+
+    sf::FloatRect everywhere {-1e6f, -1e6f, 2e6f, 2e6f};
+    auto [same, same_iter, same_max] = compute_vertices_adaptive(plant, interpretation, parameters, 0, everywhere);
+    ASSERT_EQ(exact, same);
+    ASSERT_EQ(exact_iter, same_iter);
+
+    // A region of a sixteenth of the drawing.
+    auto [min_x, max_x] = std::minmax_element(begin(exact), end(exact),
+                                              [](const auto& a, const auto& b){ return a.position.x < b.position.x; });
+    auto [min_y, max_y] = std::minmax_element(begin(exact), end(exact),
+                                              [](const auto& a, const auto& b){ return a.position.y < b.position.y; });
+    float width = max_x->position.x - min_x->position.x;
+    float height = max_y->position.y - min_y->position.y;
+    sf::FloatRect region {min_x->position.x + width / 2, min_y->position.y + height / 2, width / 4, height / 4};
+    sf::FloatRect inner {region.left + 1, region.top + 1, region.width - 2, region.height - 2};
+    auto [restricted, restricted_iter, restricted_max] =
+        compute_vertices_adaptive(plant, interpretation, parameters, 0, region);
+    ASSERT_LT(restricted.size(), exact.size() / 2);
+    ASSERT_EQ(restricted.size(), restricted_iter.size());
+    ASSERT_EQ(exact_max, restricted_max);
+    auto close = [](const sf::Vector2f& a, const sf::Vector2f& b)
+        {
+            return std::abs(a.x - b.x) < 1e-2 && std::abs(a.y - b.y) < 1e-2;
+        };
+    // The segments are the pairs of vertices.
+    int n_inside = 0;
+    for (std::size_t i = 0; i + 1 < exact.size(); i += 2)
+    {
+        if (exact[i].color == sf::Color::Transparent ||
+            !inner.contains(exact[i].position) || !inner.contains(exact[i+1].position))
+        {
+            continue;
+        }
+        ++n_inside;
+        bool found = false;
+        for (std::size_t j = 0; j + 1 < restricted.size() && !found; j += 2)
+        {
+            found = restricted[j].color != sf::Color::Transparent &&
+                close(exact[i].position, restricted[j].position) &&
+                close(exact[i+1].position, restricted[j+1].position);
+        }
+        ASSERT_TRUE(found);
+    }
+    ASSERT_GT(n_inside, 0);
+}
+
 TEST_F(DrawingTest, serialization)
 {
     InterpretationMap imap;
@@ -146,3 +318,20 @@ TEST_F(DrawingTest, serialization)
 
     ASSERT_EQ(interpretation.get_rules(), imap.get_rules());
 }
+
+TEST_F(DrawingTest, binary_serialization)
+{
+    InterpretationMap imap;
+        
+    std::stringstream ss;
+    {
+        cereal::PortableBinaryOutputArchive oarchive (ss);
+        oarchive(interpretation);
+    }
+    {
+        cereal::PortableBinaryInputArchive iarchive (ss);
+        iarchive(imap);
+    }
+
+    ASSERT_EQ(interpretation.get_rules(), imap.get_rules());
+}
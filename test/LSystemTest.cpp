@@ -188,3 +188,25 @@ TEST(LSystemTest, serialization)
     ASSERT_EQ(olsys.get_rules(), ilsys.get_rules());
     ASSERT_EQ(olsys.get_iteration_predecessors(), ilsys.get_iteration_predecessors());
 }
+
+// The caches are reset at the commit and the observers are notified once.
+TEST(LSystemTest, transaction)
+{
+    LSystem lsys { "F", { { 'F', "F+F" } }, "F" };
+    int count = 0;
+    lsys.add_observer([&count](){++count;});
+    lsys.produce(2);
+    {
+        Observable::Transaction transaction (lsys);
+        lsys.add_rule('F', "F-F");
+        lsys.add_rule('G', "GG");
+        lsys.remove_rule('G');
+        // A production in a transaction uses the current rules.
+        ASSERT_EQ(std::get<0>(lsys.produce(1)), "F-F");
+        lsys.add_rule('F', "FF");
+    }
+    ASSERT_EQ(1, count);
+    std::unordered_map<int, std::string> base_cache { { 0, "F" } };
+    ASSERT_EQ(lsys.get_production_cache(), base_cache);
+    ASSERT_EQ(std::get<0>(lsys.produce(1)), "FF");
+}
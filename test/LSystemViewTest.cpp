@@ -0,0 +1,386 @@
+#include <vector>
+#include <sstream>
+#include <gtest/gtest.h>
+#include "DiskCache.h"
+#include "LSystemView.h"
+#include "Profiler.h"
+
+using namespace procgui;
+using namespace drawing;
+
+namespace
+{
+    LSystemView lazy_koch_view()
+    {
+        return LSystemView("koch",
+                           std::make_shared<LSystem>(LSystem("F", {{'F', "F+F-F-F+F"}}, "")),
+                           std::make_shared<InterpretationMap>(default_interpretation_map),
+                           std::make_shared<DrawingParameters>(DrawingParameters({0, 0}, 0, math::pi/2, 5, 4)));
+    }
+
+    LSystemView koch_view()
+    {
+        auto view = lazy_koch_view();
+        view.materialize();
+        return view;
+    }
+
+    void expect_same_view(const LSystemView& expected, const LSystemView& view)
+    {
+        const auto& params = view.get_parameters();
+        const auto& expected_params = expected.get_parameters();
+        ASSERT_NEAR(expected_params.get_delta_angle(), params.get_delta_angle(), 1e-6);
+        ASSERT_EQ(expected_params.get_step(), params.get_step());
+        ASSERT_EQ(expected_params.get_n_iter(), params.get_n_iter());
+        ASSERT_EQ(expected.get_lsystem_buffer().get_target()->get_rules(),
+                  view.get_lsystem_buffer().get_target()->get_rules());
+
+        auto expected_box = expected.get_bounding_box();
+        auto box = view.get_bounding_box();
+        ASSERT_NEAR(expected_box.left, box.left, 1e-3);
+        ASSERT_NEAR(expected_box.top, box.top, 1e-3);
+        ASSERT_NEAR(expected_box.width, box.width, 1e-3);
+        ASSERT_NEAR(expected_box.height, box.height, 1e-3);
+    }
+}
+
+TEST(LSystemViewTest, save_file_json)
+{
+    auto view = koch_view();
+    std::stringstream ss;
+    view.save_file(ss, LSystemView::SaveFormat::JSON);
+    auto loaded = LSystemView::load_file(ss);
+    loaded.materialize();
+
+    expect_same_view(view, loaded);
+}
+
+TEST(LSystemViewTest, save_file_binary)
+{
+    auto view = koch_view();
+    std::stringstream ss;
+    view.save_file(ss, LSystemView::SaveFormat::Binary);
+    auto loaded = LSystemView::load_file(ss);
+    loaded.materialize();
+
+    expect_same_view(view, loaded);
+}
+
+// The embedded geometry is loaded without any interpretation.
+TEST(LSystemViewTest, save_file_embedded_geometry)
+{
+    auto view = koch_view();
+    std::stringstream ss;
+    view.save_file(ss, LSystemView::SaveFormat::Binary, true);
+    std::stringstream ss_models;
+    view.save_file(ss_models, LSystemView::SaveFormat::Binary, false);
+    ASSERT_GT(ss.str().size(), ss_models.str().size());
+
+    Profiler::clear();
+    auto loaded = LSystemView::load_file(ss);
+    loaded.materialize();
+
+    expect_same_view(view, loaded);
+    ASSERT_FALSE(Profiler::latest(loaded.get_id(), "drawing::compute_vertices"));
+    ASSERT_TRUE(Profiler::latest(loaded.get_id(), "LSystemView::paint_vertices"));
+}
+
+// A geometry computed in a previous session is read from the DiskCache, with
+// its iterations in the mapping of the entry, and is saved identically.
+TEST(LSystemViewTest, disk_cache)
+{
+    namespace fs = std::experimental::filesystem;
+    auto directory = fs::temp_directory_path() / "procgen_view_disk_cache_test";
+    fs::remove_all(directory);
+    DiskCache::open(directory, 1 << 20, 0);
+
+    std::stringstream computed;
+    {
+        auto view = koch_view();
+        view.save_file(computed, LSystemView::SaveFormat::Binary, true);
+    }
+
+    Profiler::clear();
+    auto view = koch_view();
+    std::stringstream cached;
+    view.save_file(cached, LSystemView::SaveFormat::Binary, true);
+    DiskCache::close();
+    fs::remove_all(directory);
+
+    ASSERT_TRUE(Profiler::latest(view.get_id(), "DiskCache::find"));
+    ASSERT_FALSE(Profiler::latest(view.get_id(), "drawing::compute_vertices"));
+    ASSERT_EQ(computed.str(), cached.str());
+}
+
+TEST(LSystemViewTest, load_file_invalid)
+{
+    std::stringstream ss ("not a save file");
+    ASSERT_THROW(LSystemView::load_file(ss), cereal::Exception);
+}
+
+// The JSON files saved before the scenes are still loaded.
+TEST(LSystemViewTest, load_file_previous_json)
+{
+    std::stringstream ss (R"({"LSystemView": {
+        "cereal_class_version": 0,
+        "name": "Plant",
+        "LSystem": {"cereal_class_version": 0, "axiom": "X",
+                    "production_rules": {"F": "FF", "X": "F[-X][X]F[-X]+FX"},
+                    "iteration_predecessor": "X"},
+        "DrawingParameters": {"cereal_class_version": 0, "starting_angle": 80.0,
+                              "delta_angle": 25.0, "step_": 4.0, "n_iter_": 3},
+        "Interpretation Map": {"cereal_class_version": 0, "F": "Go forward"}}})");
+    ASSERT_FALSE(LSystemView::is_scene(ss));
+    auto loaded = LSystemView::load_file(ss);
+    ASSERT_EQ(2u, loaded.get_lsystem_buffer().get_target()->get_rules().size());
+    ASSERT_EQ(3, loaded.get_parameters().get_n_iter());
+}
+
+TEST(LSystemViewTest, scene)
+{
+    std::vector<LSystemView> views;
+    for (int i = 0; i < 3; ++i)
+    {
+        views.push_back(koch_view());
+        views.back().ref_parameters().set_starting_position({100. * i, 50. * i});
+        views.back().compute_vertices();
+    }
+
+    for (auto format : {LSystemView::SaveFormat::JSON, LSystemView::SaveFormat::Binary})
+    {
+        for (bool embed_geometry : {false, true})
+        {
+            std::stringstream ss;
+            LSystemView::save_scene(ss, views, format, embed_geometry);
+            ASSERT_TRUE(LSystemView::is_scene(ss));
+            auto loaded = LSystemView::load_scene(ss);
+
+            ASSERT_EQ(views.size(), loaded.size());
+            auto it = begin(loaded);
+            for (const auto& view : views)
+            {
+                it->materialize();
+                ASSERT_EQ(view.get_parameters().get_starting_position(),
+                          it->get_parameters().get_starting_position());
+                expect_same_view(view, *it);
+                ++it;
+            }
+        }
+    }
+}
+
+TEST(LSystemViewTest, is_scene)
+{
+    std::stringstream single;
+    koch_view().save_file(single, LSystemView::SaveFormat::Binary);
+    ASSERT_FALSE(LSystemView::is_scene(single));
+    // The position of the stream is restored.
+    ASSERT_NO_THROW(LSystemView::load_file(single));
+
+    std::stringstream json ("  {\n \"Scene\": []}");
+    ASSERT_TRUE(LSystemView::is_scene(json));
+    ASSERT_TRUE(LSystemView::load_scene(json).empty());
+}
+
+// The geometry is only computed when requested.
+TEST(LSystemViewTest, lazy_materialization)
+{
+    Profiler::clear();
+    auto view = lazy_koch_view();
+    auto copy = view;
+    ASSERT_FALSE(view.is_materialized());
+    ASSERT_FALSE(Profiler::latest(view.get_id(), "drawing::compute_vertices"));
+    ASSERT_EQ(0.f, view.get_bounding_box().width);
+
+    // The bounding box is predicted without computing the vertices.
+    auto predicted = view.get_predicted_bounding_box();
+    ASSERT_FALSE(view.is_materialized());
+    ASSERT_FALSE(Profiler::latest(view.get_id(), "drawing::compute_vertices"));
+
+    view.materialize();
+    ASSERT_TRUE(view.is_materialized());
+    ASSERT_FALSE(view.get_scheduler().is_dirty());
+    ASSERT_TRUE(Profiler::latest(view.get_id(), "drawing::compute_vertices"));
+    auto box = view.get_bounding_box();
+    ASSERT_NEAR(5 * 81, box.width, 1e-3);
+    ASSERT_NEAR(predicted.left, box.left, 1e-3);
+    ASSERT_NEAR(predicted.top, box.top, 1e-3);
+    ASSERT_NEAR(predicted.width, box.width, 1e-3);
+    ASSERT_NEAR(predicted.height, box.height, 1e-3);
+    ASSERT_FALSE(copy.is_materialized());
+}
+
+// A prefetched geometry is received by 'materialize()' without computing it
+// again.
+TEST(LSystemViewTest, prefetch)
+{
+    auto view = lazy_koch_view();
+    view.prefetch();
+    ASSERT_TRUE(view.is_computing());
+    ASSERT_FALSE(view.get_scheduler().is_dirty());
+
+    view.materialize();
+    ASSERT_TRUE(view.is_materialized());
+    ASSERT_FALSE(view.is_computing());
+    ASSERT_NEAR(5 * 81, view.get_bounding_box().width, 1e-3);
+}
+
+// The copies share the geometry until they are modified.
+TEST(LSystemViewTest, shared_geometry)
+{
+    auto view = koch_view();
+    Profiler::clear();
+    auto duplicated = view.duplicate();
+    auto cloned = view.clone();
+    for (const auto* copy : {&duplicated, &cloned})
+    {
+        ASSERT_TRUE(copy->is_materialized());
+        ASSERT_FALSE(copy->get_scheduler().is_dirty());
+        ASSERT_FALSE(Profiler::latest(copy->get_id(), "drawing::compute_vertices"));
+        expect_same_view(view, *copy);
+    }
+
+    // Only the modified copy is computed again.
+    duplicated.ref_parameters().set_step(10);
+    duplicated.update();
+    while (duplicated.is_computing())
+    {
+        duplicated.update();
+    }
+    ASSERT_NEAR(2 * view.get_bounding_box().width, duplicated.get_bounding_box().width, 1e-3);
+    expect_same_view(view, cloned);
+}
+
+// The views whose models only differ by their position share their geometry.
+TEST(LSystemViewTest, instances)
+{
+    auto view = koch_view();
+    auto painter = std::make_shared<colors::VertexPainterWrapper>();
+    auto make_view = [&view, &painter]()
+        {
+            auto params = view.get_parameters();
+            params.set_starting_position({200, 300});
+            return LSystemView("instance",
+                               std::make_shared<LSystem>(*view.get_lsystem_buffer().get_target()),
+                               std::make_shared<InterpretationMap>(*view.get_interpretation_buffer().get_target()),
+                               std::make_shared<DrawingParameters>(params),
+                               painter);
+        };
+
+    // The first view with 'painter' computes its geometry.
+    Profiler::clear();
+    auto first = make_view();
+    first.materialize();
+    ASSERT_TRUE(Profiler::latest(first.get_id(), "drawing::compute_vertices"));
+
+    auto second = make_view();
+    second.materialize();
+    ASSERT_FALSE(Profiler::latest(second.get_id(), "drawing::compute_vertices"));
+    ASSERT_FALSE(Profiler::latest(second.get_id(), "LSystemView::paint_vertices"));
+    expect_same_view(first, second);
+
+    // Moving a view does not compute its geometry again.
+    second.ref_parameters().set_starting_position({0, 0});
+    second.update();
+    ASSERT_FALSE(second.is_computing());
+    ASSERT_FALSE(Profiler::latest(second.get_id(), "drawing::compute_vertices"));
+    ASSERT_EQ(view.get_bounding_box().left, second.get_bounding_box().left);
+
+    // A modified painter invalidates its instances.
+    painter->wrap(painter->unwrap());
+    auto third = make_view();
+    third.materialize();
+    ASSERT_TRUE(Profiler::latest(third.get_id(), "drawing::compute_vertices"));
+}
+
+// The duplicates whose shared LSystem is modified compute a single geometry
+// and keep sharing it.
+TEST(LSystemViewTest, shared_computation)
+{
+    auto view = koch_view();
+    auto duplicated = view.duplicate();
+    duplicated.ref_parameters().set_starting_position({100, 0});
+    duplicated.update();
+
+    Profiler::clear();
+    view.ref_lsystem_buffer().get_target()->add_rule('F', "F+F-F");
+    view.update();
+    duplicated.update();
+    while (view.is_computing() || duplicated.is_computing())
+    {
+        view.update();
+        duplicated.update();
+    }
+    // The first view to receive the geometry paints it.
+    ASSERT_TRUE(Profiler::latest(view.get_id(), "drawing::compute_vertices"));
+    ASSERT_FALSE(Profiler::latest(duplicated.get_id(), "drawing::compute_vertices"));
+    ASSERT_NE(bool(Profiler::latest(view.get_id(), "LSystemView::paint_vertices")),
+              bool(Profiler::latest(duplicated.get_id(), "LSystemView::paint_vertices")));
+
+    auto box = view.get_bounding_box();
+    auto duplicated_box = duplicated.get_bounding_box();
+    ASSERT_NEAR(box.left + 100, duplicated_box.left, 1e-3);
+    ASSERT_NEAR(box.width, duplicated_box.width, 1e-3);
+    ASSERT_NEAR(box.height, duplicated_box.height, 1e-3);
+
+    // The repainting of a shared painter is not duplicated either.
+    Profiler::clear();
+    auto& painter = view.ref_vertex_painter_wrapper();
+    painter.wrap(painter.unwrap());
+    view.update();
+    duplicated.update();
+    ASSERT_TRUE(Profiler::latest(view.get_id(), "LSystemView::paint_vertices"));
+    ASSERT_FALSE(Profiler::latest(duplicated.get_id(), "LSystemView::paint_vertices"));
+}
+
+// The step and the starting angle transform the geometry without
+// interpreting the LSystem again.
+TEST(LSystemViewTest, transform_geometry)
+{
+    auto view = koch_view();
+    Profiler::clear();
+
+    view.ref_parameters().set_step(7.5);
+    view.ref_parameters().set_starting_angle(math::pi / 3);
+    view.update();
+    ASSERT_FALSE(view.is_computing());
+    ASSERT_FALSE(Profiler::latest(view.get_id(), "drawing::compute_vertices"));
+    ASSERT_TRUE(Profiler::latest(view.get_id(), "LSystemView::transform_geometry"));
+
+    auto expected = lazy_koch_view();
+    expected.ref_parameters().set_step(7.5);
+    expected.ref_parameters().set_starting_angle(math::pi / 3);
+    expected.materialize();
+    expect_same_view(expected, view);
+
+    // The position only changes the transform.
+    auto generation = LSystemView::bounds_generation();
+    view.ref_parameters().set_starting_position({100, 100});
+    ASSERT_FALSE(view.get_scheduler().is_dirty());
+    ASSERT_LT(generation, LSystemView::bounds_generation());
+    ASSERT_NEAR(expected.get_bounding_box().left + 100, view.get_bounding_box().left, 1e-3);
+
+    // The delta angle needs a new interpretation.
+    view.ref_parameters().set_delta_angle(math::pi / 3);
+    do
+    {
+        view.update();
+    } while (view.is_computing());
+    ASSERT_TRUE(Profiler::latest(view.get_id(), "drawing::compute_vertices"));
+}
+
+// An interpretation with too many vertices is refused without being computed.
+TEST(LSystemViewTest, refused_vertices)
+{
+    LSystemView view ("doubling",
+                      std::make_shared<LSystem>(LSystem("F", {{'F', "FF"}}, "")),
+                      std::make_shared<InterpretationMap>(default_interpretation_map),
+                      std::make_shared<DrawingParameters>(DrawingParameters({0, 0}, 0, math::pi/2, 5, 40)));
+    view.materialize();
+    ASSERT_EQ(std::uint64_t(1) << 41, view.get_refused_vertices());
+    ASSERT_EQ(0.f, view.get_bounding_box().width);
+
+    view.ref_parameters().set_n_iter(4);
+    view.compute_vertices();
+    ASSERT_EQ(0u, view.get_refused_vertices());
+}
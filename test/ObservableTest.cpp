@@ -1,3 +1,4 @@
+#include <vector>
 #include <gtest/gtest.h>
 
 #include "Observer.h"
@@ -19,7 +20,7 @@ struct A : public Observable
         }
     bool empty() const
         {
-            return observers_.empty();
+            return !has_observers();
         }
 };
 
@@ -37,7 +38,7 @@ struct B : public Observable
         }
     bool empty() const
         {
-            return observers_.empty();
+            return !has_observers();
         }
 };
     
@@ -149,3 +150,54 @@ TEST(ObservableTest, set_target)
     ASSERT_FALSE(a2->empty());
     ASSERT_EQ(1, c.n);
 }
+
+// The notifications of a transaction are grouped into one, at the commit of
+// the outermost transaction.
+TEST(ObservableTest, transaction)
+{
+    auto a = std::make_shared<A>(0);
+    int count = 0;
+    a->add_observer([&count](){++count;});
+    {
+        Observable::Transaction transaction (*a);
+        a->increment();
+        {
+            Observable::Transaction nested (*a);
+            a->increment();
+        }
+        ASSERT_EQ(0, count);
+    }
+    ASSERT_EQ(1, count);
+
+    // Without modification, nothing is notified.
+    a->begin_transaction();
+    a->commit_transaction();
+    ASSERT_EQ(1, count);
+}
+
+// Replacing a callback keeps the order of the notifications, a moved
+// Observable keeps its observers, and a callback can disconnect its own slot.
+TEST(ObservableTest, slots)
+{
+    auto a = std::make_shared<A>(0);
+    std::vector<int> calls;
+    Observable::Slot first;
+    Observable::Slot second;
+    first.connect(*a, [&calls](){calls.push_back(1);});
+    second.connect(*a, [&calls](){calls.push_back(2);});
+    first.connect(*a, [&calls](){calls.push_back(3);});
+    a->increment();
+    ASSERT_EQ(std::vector<int>({3, 2}), calls);
+
+    A moved (std::move(*a));
+    ASSERT_TRUE(a->empty());
+    calls.clear();
+    second.connect(moved, [&calls, &second](){calls.push_back(4); second.disconnect();});
+    moved.increment();
+    moved.increment();
+    ASSERT_EQ(std::vector<int>({3, 4, 3}), calls);
+    ASSERT_FALSE(second.is_connected());
+
+    first.disconnect();
+    ASSERT_TRUE(moved.empty());
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "Production.h"
+
+namespace
+{
+    // Empty successor, terminals and counted terminals.
+    LSystem lsys {"X+E", {{'X', "F[+X]E-X"}, {'F', "FF"}, {'E', ""}}, "X+"};
+}
+
+TEST(ProductionTest, size)
+{
+    Production production (lsys, 6);
+
+    for (int n = 0; n <= 6; ++n)
+    {
+        ASSERT_EQ(std::get<0>(lsys.produce(n)).size(), production.size(n));
+    }
+    ASSERT_EQ(6, production.get_max_iteration());
+}
+
+TEST(ProductionTest, saturated)
+{
+    Production production ({"F", {{'F', "FF"}}, ""}, 70);
+
+    ASSERT_EQ(std::uint64_t(1) << 63, production.size(63));
+    ASSERT_EQ(Production::SATURATED, production.size(64));
+    ASSERT_EQ(Production::SATURATED, production.size(70));
+    ASSERT_EQ('F', production.symbol_at(63, (std::uint64_t(1) << 63) - 1));
+}
+
+TEST(ProductionTest, symbol_at)
+{
+    Production production (lsys, 6);
+
+    for (int n = 0; n <= 6; ++n)
+    {
+        auto [str, iterations, max_iteration] = lsys.produce(n);
+        for (std::size_t i = 0; i < str.size(); ++i)
+        {
+            ASSERT_EQ(str[i], production.symbol_at(n, i));
+            ASSERT_EQ(iterations[i], production.iteration_at(n, i));
+        }
+    }
+}
+
+TEST(ProductionTest, cursor)
+{
+    Production production (lsys, 6);
+    auto [str, iterations, max_iteration] = lsys.produce(6);
+
+    for (std::size_t offset : {std::size_t(0), std::size_t(1), str.size() / 3, str.size() - 1, str.size()})
+    {
+        std::string symbols;
+        std::vector<int> counts;
+        for (auto cursor = production.cursor(6, offset); !cursor.is_done(); cursor.next())
+        {
+            ASSERT_EQ(offset + symbols.size(), cursor.position());
+            symbols.push_back(cursor.symbol());
+            counts.push_back(cursor.iteration());
+        }
+        ASSERT_EQ(str.substr(offset), symbols);
+        ASSERT_EQ(std::vector<int>(begin(iterations) + offset, end(iterations)), counts);
+    }
+}
+
+TEST(ProductionTest, split)
+{
+    Production production (lsys, 6);
+    auto str = std::get<0>(lsys.produce(6));
+
+    auto bounds = production.split(6, 7);
+    ASSERT_EQ(8u, bounds.size());
+    ASSERT_EQ(0u, bounds.front());
+    ASSERT_EQ(str.size(), bounds.back());
+
+    std::string symbols;
+    for (std::size_t k = 0; k + 1 < bounds.size(); ++k)
+    {
+        ASSERT_LE(bounds[k+1] - bounds[k], str.size() / 7 + 1);
+        auto cursor = production.cursor(6, bounds[k]);
+        for (; cursor.position() < bounds[k+1]; cursor.next())
+        {
+            symbols.push_back(cursor.symbol());
+        }
+    }
+    ASSERT_EQ(str, symbols);
+}
+
+TEST(ProductionTest, empty_axiom)
+{
+    Production production ({"", {{'F', "FF"}}, ""}, 3);
+
+    ASSERT_EQ(0u, production.size(3));
+    ASSERT_TRUE(production.cursor(3).is_done());
+    ASSERT_EQ(std::vector<std::uint64_t>({0, 0}), production.split(3, 1));
+}
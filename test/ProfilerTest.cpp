@@ -0,0 +1,60 @@
+#include <memory>
+#include <sstream>
+#include <gtest/gtest.h>
+
+#include "Profiler.h"
+
+TEST(ProfilerTest, scope)
+{
+    Profiler::clear();
+    {
+        Profiler::Context context (42);
+        Profiler::Scope scope ("test_scope", 3);
+        auto block = std::make_unique<char[]>(1000);
+        scope.set_items(5);
+    }
+
+    auto sample = Profiler::latest(42, "test_scope");
+    ASSERT_TRUE(sample);
+    ASSERT_EQ(5u, sample->items);
+    if (Profiler::COUNTS_ALLOCATIONS)
+    {
+        ASSERT_GE(sample->allocated_bytes, 1000u);
+    }
+    ASSERT_GE(sample->duration.count(), 0);
+
+    // The context is restored at the end of the Context.
+    ASSERT_FALSE(Profiler::latest(Profiler::NO_CONTEXT, "test_scope"));
+}
+
+TEST(ProfilerTest, memory)
+{
+    if (!Profiler::COUNTS_ALLOCATIONS)
+    {
+        GTEST_SKIP();
+    }
+
+    auto live = Profiler::live_bytes();
+    Profiler::reset_peak_bytes();
+    {
+        auto block = std::make_unique<char[]>(1 << 20);
+        ASSERT_GE(Profiler::live_bytes(), live + (1 << 20));
+    }
+    ASSERT_GE(Profiler::peak_bytes(), live + (1 << 20));
+    ASSERT_LT(Profiler::live_bytes(), live + (1 << 20));
+}
+
+TEST(ProfilerTest, chrome_trace)
+{
+    Profiler::clear();
+    {
+        Profiler::Scope scope ("traced_scope");
+    }
+
+    std::ostringstream oss;
+    Profiler::export_chrome_trace(oss);
+    auto trace = oss.str();
+    ASSERT_NE(std::string::npos, trace.find("\"traceEvents\""));
+    ASSERT_NE(std::string::npos, trace.find("\"name\": \"traced_scope\""));
+    ASSERT_NE(std::string::npos, trace.find("\"ph\": \"X\""));
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "SceneRegistry.h"
+
+using namespace procgui;
+
+namespace
+{
+    LSystemView view_at(double x)
+    {
+        return LSystemView(ext::sf::Vector2d(x, 0));
+    }
+
+    double position(const LSystemView* view)
+    {
+        return view->get_parameters().get_starting_position().x;
+    }
+}
+
+TEST(SceneRegistryTest, insert_get)
+{
+    SceneRegistry registry;
+    auto first = registry.insert(view_at(1));
+    auto second = registry.insert(view_at(2));
+
+    ASSERT_EQ(2u, registry.size());
+    ASSERT_NE(first, second);
+    ASSERT_EQ(1, position(registry.get(first)));
+    ASSERT_EQ(2, position(registry.get(second)));
+    ASSERT_EQ(second, registry.handle_at(1));
+    ASSERT_FALSE(registry.get(SceneRegistry::Handle {}));
+}
+
+// The handles of the other views stay valid after an erasure, the handles of
+// the erased view are stale even when its slot is reused.
+TEST(SceneRegistryTest, erase)
+{
+    SceneRegistry registry;
+    auto first = registry.insert(view_at(1));
+    auto second = registry.insert(view_at(2));
+    auto third = registry.insert(view_at(3));
+
+    registry.erase(first);
+    ASSERT_EQ(2u, registry.size());
+    ASSERT_FALSE(registry.contains(first));
+    ASSERT_EQ(nullptr, registry.get(first));
+    ASSERT_EQ(2, position(registry.get(second)));
+    ASSERT_EQ(3, position(registry.get(third)));
+    // The last view took the place of the erased one.
+    ASSERT_EQ(third, registry.handle_at(0));
+
+    auto fourth = registry.insert(view_at(4));
+    ASSERT_EQ(first.index, fourth.index);
+    ASSERT_NE(first, fourth);
+    ASSERT_EQ(nullptr, registry.get(first));
+    ASSERT_EQ(4, position(registry.get(fourth)));
+
+    registry.erase(second);
+    registry.erase(third);
+    registry.erase(fourth);
+    ASSERT_TRUE(registry.empty());
+}
+
+// The identifiers of the erased views are reused.
+TEST(SceneRegistryTest, ids)
+{
+    SceneRegistry registry;
+    auto first = registry.insert(view_at(1));
+    registry.insert(view_at(2));
+    int id = registry.get(first)->get_id();
+
+    registry.erase(first);
+    auto third = registry.insert(view_at(3));
+    ASSERT_EQ(id, registry.get(third)->get_id());
+}
@@ -0,0 +1,89 @@
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "UpdateScheduler.h"
+
+class UpdateSchedulerTest : public ::testing::Test
+{
+public:
+    UpdateSchedulerTest()
+        {
+            scheduler.set_task(UpdateScheduler::Derive, [this](){calls.push_back(UpdateScheduler::Derive);});
+            scheduler.set_task(UpdateScheduler::Interpret, [this](){calls.push_back(UpdateScheduler::Interpret);});
+            scheduler.set_task(UpdateScheduler::Paint, [this](){calls.push_back(UpdateScheduler::Paint);});
+        }
+
+    UpdateScheduler scheduler;
+    std::vector<int> calls;
+};
+
+TEST_F(UpdateSchedulerTest, nothing_to_flush)
+{
+    scheduler.flush();
+
+    ASSERT_FALSE(scheduler.is_dirty());
+    ASSERT_TRUE(calls.empty());
+    ASSERT_EQ(0u, scheduler.get_counters().flushes);
+}
+
+TEST_F(UpdateSchedulerTest, coalesce)
+{
+    scheduler.mark(UpdateScheduler::Paint);
+    scheduler.mark(UpdateScheduler::Paint);
+    scheduler.mark(UpdateScheduler::Paint);
+    ASSERT_TRUE(scheduler.is_dirty());
+    ASSERT_TRUE(calls.empty());
+
+    scheduler.flush();
+
+    std::vector<int> expected_calls {UpdateScheduler::Paint};
+    ASSERT_EQ(expected_calls, calls);
+    ASSERT_FALSE(scheduler.is_dirty());
+    ASSERT_EQ(2u, scheduler.get_counters().coalesced());
+}
+
+TEST_F(UpdateSchedulerTest, dependency_order)
+{
+    scheduler.mark(UpdateScheduler::Paint);
+    scheduler.mark(UpdateScheduler::Interpret);
+    scheduler.mark(UpdateScheduler::Paint);
+    scheduler.mark(UpdateScheduler::Interpret);
+
+    scheduler.flush();
+    scheduler.flush();
+
+    std::vector<int> expected_calls {UpdateScheduler::Interpret, UpdateScheduler::Paint};
+    ASSERT_EQ(expected_calls, calls);
+    ASSERT_EQ(1u, scheduler.get_counters().coalesced(UpdateScheduler::Interpret));
+    ASSERT_EQ(1u, scheduler.get_counters().coalesced(UpdateScheduler::Paint));
+    ASSERT_EQ(1u, scheduler.get_counters().flushes);
+}
+
+TEST_F(UpdateSchedulerTest, nested_mark)
+{
+    // A task marking a stage is executed at the next flush.
+    scheduler.set_task(UpdateScheduler::Interpret,
+                       [this]()
+                       {
+                           calls.push_back(UpdateScheduler::Interpret);
+                           scheduler.mark(UpdateScheduler::Paint);
+                       });
+    scheduler.mark(UpdateScheduler::Derive);
+
+    scheduler.flush();
+    ASSERT_TRUE(scheduler.is_dirty());
+    scheduler.flush();
+
+    std::vector<int> expected_calls {UpdateScheduler::Derive, UpdateScheduler::Interpret,
+                                     UpdateScheduler::Paint, UpdateScheduler::Paint};
+    ASSERT_EQ(expected_calls, calls);
+}
+
+TEST_F(UpdateSchedulerTest, clear)
+{
+    scheduler.mark(UpdateScheduler::Derive);
+    scheduler.clear();
+    scheduler.flush();
+
+    ASSERT_TRUE(calls.empty());
+}
@@ -0,0 +1,50 @@
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "WorkerPool.h"
+
+TEST(WorkerPoolTest, submit)
+{
+    WorkerPool pool (2);
+    auto f1 = pool.submit([](){return 1;});
+    auto f2 = pool.submit([](){return 2;});
+
+    ASSERT_EQ(1, f1.get());
+    ASSERT_EQ(2, f2.get());
+}
+
+TEST(WorkerPoolTest, exception)
+{
+    WorkerPool pool (1);
+    auto f = pool.submit([]() -> int {throw std::runtime_error("error");});
+
+    ASSERT_THROW(f.get(), std::runtime_error);
+}
+
+TEST(WorkerPoolTest, shutdown)
+{
+    // The running task is finished, the queued ones are discarded.
+    WorkerPool pool (1);
+    std::promise<void> started;
+    std::promise<void> release;
+    auto running = pool.submit([&started, released = release.get_future()]()
+                               {
+                                   started.set_value();
+                                   released.wait();
+                                   return 1;
+                               });
+    started.get_future().wait();
+    auto queued = pool.submit([](){return 2;});
+
+    std::thread stopping ([&pool](){pool.shutdown();});
+    // Broken as soon as it is discarded, while the running task is blocked.
+    queued.wait();
+    release.set_value();
+    stopping.join();
+
+    ASSERT_EQ(1, running.get());
+    ASSERT_THROW(queued.get(), std::future_error);
+    ASSERT_THROW(pool.submit([](){return 3;}).get(), std::future_error);
+}
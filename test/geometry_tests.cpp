@@ -1,7 +1,9 @@
 #include <cmath>
+#include <random>
 #include <gtest/gtest.h>
 #include "helper_math.h"
 #include "geometry.h"
+#include "WorkerPool.h"
 
 using namespace geometry;
 
@@ -83,3 +85,202 @@ TEST(geometry, project_and_clamp)
     ASSERT_FLOAT_EQ(proj.x, 1);
     ASSERT_FLOAT_EQ(proj.y, 1);
 }
+
+TEST(geometry, chunk_boxes)
+{
+    std::vector<sf::Vertex> line { {{0, 0}}, {{1, 0}}, {{2, 0}}, {{3, 0}}, {{4, 0}} };
+    std::vector<sf::FloatRect> expected_boxes { {0, 0, 2, 0}, {2, 0, 2, 0}, {4, 0, 0, 0} };
+
+    ASSERT_EQ(expected_boxes, chunk_boxes(line, 2));
+}
+
+TEST(geometry, visible_ranges)
+{
+    std::vector<sf::Vertex> line;
+    for (int i = 0; i < 10; ++i)
+    {
+        line.push_back({{static_cast<float>(i), 0}});
+    }
+    auto boxes = chunk_boxes(line, 3);
+
+    // Nothing visible.
+    ASSERT_TRUE(visible_ranges(boxes, 3, line.size(), {20, 20, 1, 1}).empty());
+
+    // Everything visible: a single range.
+    std::vector<std::pair<std::size_t, std::size_t>> all {{0, 10}};
+    ASSERT_EQ(all, visible_ranges(boxes, 3, line.size(), {-1, -1, 20, 2}));
+
+    // Only the chunks [0,3] and [3,6] overlap the area, merged into one range.
+    std::vector<std::pair<std::size_t, std::size_t>> first_chunks {{0, 7}};
+    ASSERT_EQ(first_chunks, visible_ranges(boxes, 3, line.size(), {0.5, -1, 4, 2}));
+}
+
+TEST(geometry, overlap)
+{
+    sf::FloatRect box {0, 0, 10, 10};
+    sf::FloatRect flat {5, 5, 10, 0};
+    sf::FloatRect touching {10, 10, 5, 5};
+    sf::FloatRect outside {11, 0, 5, 5};
+
+    ASSERT_TRUE(overlap(box, flat));
+    ASSERT_TRUE(overlap(box, touching));
+    ASSERT_FALSE(overlap(box, outside));
+}
+
+TEST(geometry, simplify)
+{
+    std::vector<sf::Vertex> line;
+    for (int i = 0; i <= 10; ++i)
+    {
+        line.push_back({{static_cast<float>(i), 0}});
+    }
+
+    // The vertices closer than the tolerance are removed.
+    std::vector<sf::Vertex> simplified = simplify(line, 2.5);
+    std::vector<sf::Vector2f> expected_positions { {0, 0}, {3, 0}, {6, 0}, {9, 0}, {10, 0} };
+    ASSERT_EQ(expected_positions.size(), simplified.size());
+    for (std::size_t i = 0; i < simplified.size(); ++i)
+    {
+        ASSERT_EQ(expected_positions.at(i), simplified.at(i).position);
+    }
+
+    // The borders of the color runs are kept.
+    line.at(5).color = sf::Color::Transparent;
+    simplified = simplify(line, 100);
+    std::vector<sf::Vector2f> expected_borders { {0, 0}, {4, 0}, {5, 0}, {6, 0}, {10, 0} };
+    ASSERT_EQ(expected_borders.size(), simplified.size());
+    for (std::size_t i = 0; i < simplified.size(); ++i)
+    {
+        ASSERT_EQ(expected_borders.at(i), simplified.at(i).position);
+    }
+
+    // A gradient is a single color run with a color tolerance, but not a
+    // sharp color change.
+    for (int i = 0; i <= 10; ++i)
+    {
+        line.at(i).color = sf::Color(20 * i, 0, 0);
+    }
+    ASSERT_EQ(11u, simplify(line, 100).size());
+    ASSERT_EQ(11u, simplify(line, 100, 19).size());
+    ASSERT_EQ(2u, simplify(line, 100, 20).size());
+    line.at(5).color = sf::Color::Transparent;
+    ASSERT_EQ(5u, simplify(line, 100, 20).size());
+}
+
+namespace
+{
+    // The original scalar implementations of 'bounding_box()' and
+    // 'sub_boxes()', used as references.
+    sf::FloatRect reference_bounding_box(const std::vector<sf::Vertex>& vertices)
+    {
+        if (vertices.size() == 0)
+        {
+            return { 0, 0, 0, 0 };
+        }
+        const auto& first = vertices.at(0);
+        float top = first.position.y, down = first.position.y;
+        float left = first.position.x, right = first.position.x;
+        for (const auto& v : vertices)
+        {
+            if (v.position.y < top)
+            {
+                top = v.position.y;
+            }
+            else if (v.position.y > down)
+            {
+                down = v.position.y;
+            }
+
+            if (v.position.x > right)
+            {
+                right = v.position.x;
+            }
+            else if (v.position.x < left)
+            {
+                left = v.position.x;
+            }
+        }
+        return {left, top, right - left, down - top};
+    }
+
+    std::vector<sf::FloatRect> reference_sub_boxes(const std::vector<sf::Vertex>& vertices,
+                                                   int max_boxes)
+    {
+        if (max_boxes == 1)
+        {
+            max_boxes = 2;
+        }
+        std::vector<sf::FloatRect> boxes;
+        int vertices_per_box = vertices.size()  / (max_boxes-1);
+        vertices_per_box = vertices_per_box < 4 ? 4 : vertices_per_box;
+        int n = 0;
+        std::vector<sf::Vertex> box_vertices;
+        for (size_t i = 0; i<vertices.size(); ++i)
+        {
+            if (n == vertices_per_box)
+            {
+                n = 0;
+                i -= 3;
+                boxes.push_back(reference_bounding_box(box_vertices));
+                box_vertices.clear();
+            }
+            box_vertices.push_back(vertices.at(i));
+            ++n;
+            if (i == vertices.size()-1)
+            {
+                boxes.push_back(reference_bounding_box(box_vertices));
+            }
+        }
+        return boxes;
+    }
+
+    // A random walk of 'n' vertices.
+    std::vector<sf::Vertex> random_walk(std::size_t n)
+    {
+        std::mt19937 generator (n);
+        std::uniform_real_distribution<float> step (-10, 10);
+        std::vector<sf::Vertex> walk;
+        sf::Vector2f position {0, 0};
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            position += {step(generator), step(generator)};
+            walk.push_back({position});
+        }
+        return walk;
+    }
+}
+
+// The vectorized and parallel bounding boxes are identical to the scalar ones.
+TEST(geometry, bounding_box_reference)
+{
+    for (std::size_t n : {0, 1, 2, 3, 4, 5, 7, 8, 9, 100, 1001, 1 << 20})
+    {
+        auto walk = random_walk(n);
+        ASSERT_EQ(reference_bounding_box(walk), bounding_box(walk)) << n << " vertices";
+    }
+}
+
+// In a worker, the computations are not split between threads.
+TEST(geometry, bounding_box_in_worker)
+{
+    auto walk = random_walk(1 << 20);
+    WorkerPool workers (1);
+    auto box = workers.submit([&walk](){return bounding_box(walk);}).get();
+    auto boxes = workers.submit([&walk](){return sub_boxes(walk, 9);}).get();
+    ASSERT_EQ(reference_bounding_box(walk), box);
+    ASSERT_EQ(reference_sub_boxes(walk, 9), boxes);
+}
+
+// The copy-free sub-boxes are identical to the original ones.
+TEST(geometry, sub_boxes_reference)
+{
+    for (std::size_t n : {0, 1, 3, 4, 5, 8, 13, 31, 32, 33, 100, 1001, 1 << 20})
+    {
+        auto walk = random_walk(n);
+        for (int max_boxes : {1, 2, 3, 8, 9, 64})
+        {
+            ASSERT_EQ(reference_sub_boxes(walk, max_boxes), sub_boxes(walk, max_boxes))
+                << n << " vertices, " << max_boxes << " boxes";
+        }
+    }
+}